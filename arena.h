@@ -4,6 +4,7 @@
 #define _XOPEN_SOURCE 500L
 #define _GNU_SOURCE
 #include <assert.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -55,15 +56,31 @@ static bool cli_log_verbose = false;
 
 #define pg_max(a, b) (((a) > (b)) ? (a) : (b))
 
+#define pg_min(a, b) (((a) < (b)) ? (a) : (b))
+
 // --------------------------- Arena
 
 typedef struct Mem_profile Mem_profile;
+typedef struct Arena_source Arena_source;
 typedef struct {
   u8 *start;
   u8 *end;
+  // When set, allocations stop there instead of at `end`. Offsets, and thus
+  // handles, stay relative to `end`. See `arena_slice`.
+  u8 *limit;
   Mem_profile *profile;
+  // When set, a slice which runs out of memory takes a new chunk from there
+  // instead of aborting.
+  Arena_source *source;
 } Arena;
 
+// The arena that slices handed over to other threads come from.
+struct Arena_source {
+  Arena *arena; // Guarded by `lock`.
+  pthread_mutex_t lock;
+  u64 chunk_size; // Minimum size of the chunks taken.
+};
+
 __attribute__((warn_unused_result)) static u32 arena_offset_from_end(void *ptr,
                                                                      Arena a) {
   pg_assert((u8 *)ptr <= a.end);
@@ -91,18 +108,29 @@ arena_new(u64 cap, Mem_profile *profile) {
 static void mem_profile_record_alloc(Mem_profile *profile, u64 objects_count,
                                      u64 bytes_count);
 
+static void arena_take_chunk(Arena *a, u64 size);
+
 __attribute__((warn_unused_result))
 __attribute((malloc, alloc_size(2, 4), alloc_align(3))) static void *
 arena_alloc(Arena *a, size_t size, size_t align, size_t count) {
-  pg_assert(a->start <= a->end);
+  u8 *limit = a->limit != NULL ? a->limit : a->end;
+  pg_assert(a->start <= limit);
   pg_assert(size > 0);
   pg_assert(align == 1 || align == 2 || align == 4 || align == 8);
 
-  u64 available = (u64)a->end - (u64)a->start;
+  u64 available = (u64)limit - (u64)a->start;
   u64 padding = -(u64)a->start & (align - 1);
 
   // Ignore overflow for now.
   size_t offset = padding + size * count;
+  if (available < offset && a->source != NULL) {
+    arena_take_chunk(a, size * count + align);
+
+    limit = a->limit;
+    available = (u64)limit - (u64)a->start;
+    padding = -(u64)a->start & (align - 1);
+    offset = padding + size * count;
+  }
   if (available < offset) {
     fprintf(stderr,
             "Out of memory: available=%lu "
@@ -112,11 +140,11 @@ arena_alloc(Arena *a, size_t size, size_t align, size_t count) {
   }
 
   u8 *res = a->start + padding;
-  pg_assert(res + count * size <= a->end);
+  pg_assert(res + count * size <= limit);
   memset(res, 0, size * count);
 
   a->start += offset;
-  pg_assert(a->start <= a->end);
+  pg_assert(a->start <= limit);
 
   if (a->profile) {
     mem_profile_record_alloc(a->profile, count, offset);
@@ -124,3 +152,55 @@ arena_alloc(Arena *a, size_t size, size_t align, size_t count) {
 
   return (void *)res;
 }
+
+// Carve `size` bytes out of the arena, as a new arena which can be handed over
+// to another thread. The handles it creates are valid in the original arena.
+// Set its `source` for it to take more memory when it runs out.
+__attribute__((warn_unused_result)) static Arena arena_slice(Arena *a,
+                                                             u64 size) {
+  u8 *const limit = a->limit != NULL ? a->limit : a->end;
+  pg_assert(a->start <= limit);
+
+  const u64 padding = -(u64)a->start & 7;
+  const u64 available = (u64)limit - (u64)a->start;
+  if (available < padding + size) {
+    fprintf(stderr,
+            "Out of memory: available=%lu "
+            "allocation_size=%lu\n",
+            available, padding + size);
+    abort();
+  }
+
+  // Not zeroed: `arena_alloc` zeroes each allocation anyway.
+  u8 *const start = a->start + padding;
+  a->start = start + size;
+
+  if (a->profile) {
+    mem_profile_record_alloc(a->profile, 1, padding + size);
+  }
+
+  return (Arena){.start = start, .end = a->end, .limit = start + size};
+}
+
+// Replace the memory of the slice `a` by a new chunk of at least `size` bytes
+// from its source. The rest of the previous chunk is lost.
+static void arena_take_chunk(Arena *a, u64 size) {
+  Arena_source *const source = a->source;
+  pg_assert(source != NULL);
+  pg_assert(source->arena != NULL);
+
+  int res = pthread_mutex_lock(&source->lock);
+  pg_assert(res == 0);
+
+  // Accounted for as a whole in the memory profile of the source, if any,
+  // since the profile is not thread-safe.
+  const Arena chunk =
+      arena_slice(source->arena, pg_max(size, source->chunk_size));
+
+  res = pthread_mutex_unlock(&source->lock);
+  pg_assert(res == 0);
+
+  pg_assert(chunk.end == a->end);
+  a->start = chunk.start;
+  a->limit = chunk.limit;
+}
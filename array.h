@@ -11,8 +11,14 @@
     T *data;                                                                   \
   } Array(T);
 
+// A function so that a constant `_len` of 0 is not compared against an
+// unsigned `_cap` in the caller, which -Wtype-limits warns about.
+static void array_assert_len_cap(u64 len, u64 cap) {
+  pg_assert(len <= cap);
+}
+
 #define array_make(T, _len, _cap, _arena)                                      \
-  (pg_assert(_len <= _cap),                                                    \
+  (array_assert_len_cap(_len, _cap),                                           \
    ((Array(T)){                                                                \
        .len = _len,                                                            \
        .cap = _cap,                                                            \
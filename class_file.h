@@ -4,19 +4,23 @@
 #include "array.h"
 #include "str.h"
 
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-#ifdef WITH_ZLIB
-#include <zlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
 #endif
 
 typedef enum {
@@ -314,7 +318,7 @@ struct Type {
   } v;
   Type_kind kind;
   u16 flags;
-  pg_pad(4);
+  Type_handle index_next; // Next type with the same key in the `Type_index`.
 };
 
 typedef struct Type Type;
@@ -448,13 +452,363 @@ typedef struct {
   pg_pad(3);
 } Parser;
 
+// A source file and everything derived from it, from the tokens to the class
+// file.
+typedef struct {
+  Str file_path;
+  Str source;
+  Str class_file_path;
+  Lexer lexer;
+  Parser parser;
+  Ast_handle root_handle;
+  Type_handle this_class_type_handle;
+  u32 methods_count;
+  pg_pad(4);
+} Source_file;
+Array_struct(Source_file);
+
+// Hash trie mapping a (package, name) key to all the types registered under
+// it, in insertion order, chained by `Type.index_next`.
+typedef struct Type_index Type_index;
+struct Type_index {
+  Type_index *children[4];
+  Str package_name;
+  Str name;
+  Type_handle first;
+  Type_handle last;
+};
+
+static u64 type_index_hash(Str package_name, Str name) {
+  u64 hash = ut_fnv1a(UT_FNV1A_OFFSET_BASIS, package_name.data,
+                      package_name.len);
+  hash = ut_fnv1a(hash, ".", 1);
+  return ut_fnv1a(hash, name.data, name.len);
+}
+
+// Returns the slot for the key, which is `NULL` if the key is not present.
+static Type_index **type_index_find(Type_index **index, Str package_name,
+                                    Str name) {
+  pg_assert(index != NULL);
+
+  for (u64 hash = type_index_hash(package_name, name); *index != NULL;
+       hash <<= 2) {
+    if (str_eq(package_name, (*index)->package_name) &&
+        str_eq(name, (*index)->name))
+      return index;
+
+    index = &(*index)->children[hash >> 62];
+  }
+  return index;
+}
+
+static void type_index_insert(Type_index **index, Str package_name, Str name,
+                              Type_handle handle, Arena *arena) {
+  pg_assert(index != NULL);
+  pg_assert(!type_handle_handles_nil(handle));
+  pg_assert(arena != NULL);
+
+  Type_index **const slot = type_index_find(index, package_name, name);
+  if (*slot == NULL) {
+    *slot = arena_alloc(arena, sizeof(Type_index), _Alignof(Type_index), 1);
+    (*slot)->package_name = package_name;
+    (*slot)->name = name;
+    (*slot)->first = (*slot)->last = handle;
+    return;
+  }
+
+  type_handle_to_ptr((*slot)->last, *arena)->index_next = handle;
+  (*slot)->last = handle;
+}
+
+static Type_handle type_index_get_first(Type_index *index, Str package_name,
+                                        Str name) {
+  Type_index *const node = *type_index_find(&index, package_name, name);
+  return node == NULL ? type_handle_nil : node->first;
+}
+
+// Hash trie of all the types added to the resolver, keyed by their structure,
+// so that equal types share the same handle.
+typedef struct Type_intern Type_intern;
+struct Type_intern {
+  Type_intern *children[4];
+  Type_handle handle;
+  pg_pad(4);
+};
+
+static u64 type_intern_hash_str(u64 hash, Str s) {
+  hash = ut_fnv1a(hash, &s.len, sizeof(s.len));
+  return ut_fnv1a(hash, s.data, s.len);
+}
+
+static u64 type_intern_hash(const Type *type) {
+  pg_assert(type != NULL);
+
+  u64 hash = ut_fnv1a(UT_FNV1A_OFFSET_BASIS, &type->kind, sizeof(type->kind));
+  hash = ut_fnv1a(hash, &type->flags, sizeof(type->flags));
+  hash = type_intern_hash_str(hash, type->this_class_name);
+  hash = type_intern_hash_str(hash, type->super_class_name);
+  hash = type_intern_hash_str(hash, type->package_name);
+
+  switch (type->kind) {
+  case TYPE_METHOD:
+  case TYPE_CONSTRUCTOR: {
+    const Method *const method = &type->v.method;
+    hash = type_intern_hash_str(hash, method->name);
+    hash = ut_fnv1a(hash, &method->return_type_handle,
+                    sizeof(method->return_type_handle));
+    hash = ut_fnv1a(hash, method->argument_type_handles.data,
+                    method->argument_type_handles.len * sizeof(Type_handle));
+    hash = ut_fnv1a(hash, &method->access_flags, sizeof(method->access_flags));
+    hash = ut_fnv1a(hash, &method->source_line, sizeof(method->source_line));
+    break;
+  }
+  case TYPE_ARRAY:
+    hash = ut_fnv1a(hash, &type->v.array_type_handles,
+                    sizeof(type->v.array_type_handles));
+    break;
+  case TYPE_INTEGER_LITERAL:
+    hash = ut_fnv1a(hash, &type->v.integer_literal_types,
+                    sizeof(type->v.integer_literal_types));
+    break;
+  default:
+    break;
+  }
+
+  return hash;
+}
+
+static bool type_intern_eq(const Type *a, const Type *b) {
+  pg_assert(a != NULL);
+  pg_assert(b != NULL);
+
+  if (a->kind != b->kind || a->flags != b->flags ||
+      !str_eq(a->this_class_name, b->this_class_name) ||
+      !str_eq(a->super_class_name, b->super_class_name) ||
+      !str_eq(a->package_name, b->package_name))
+    return false;
+
+  switch (a->kind) {
+  case TYPE_METHOD:
+  case TYPE_CONSTRUCTOR: {
+    const Method *const a_method = &a->v.method;
+    const Method *const b_method = &b->v.method;
+
+    if (!str_eq(a_method->name, b_method->name) ||
+        !str_eq(a_method->source_file_name, b_method->source_file_name) ||
+        a_method->return_type_handle.value !=
+            b_method->return_type_handle.value ||
+        a_method->this_class_type_handle.value !=
+            b_method->this_class_type_handle.value ||
+        a_method->access_flags != b_method->access_flags ||
+        a_method->source_line != b_method->source_line)
+      return false;
+
+    // InlineOnly methods own their code and constant pool.
+    if (a_method->code.data != b_method->code.data ||
+        a_method->constant_pool.data != b_method->constant_pool.data)
+      return false;
+
+    if (a_method->argument_type_handles.len !=
+        b_method->argument_type_handles.len)
+      return false;
+
+    for (u64 i = 0; i < a_method->argument_type_handles.len; i++) {
+      if (a_method->argument_type_handles.data[i].value !=
+          b_method->argument_type_handles.data[i].value)
+        return false;
+    }
+    return true;
+  }
+  case TYPE_ARRAY:
+    return a->v.array_type_handles.value == b->v.array_type_handles.value;
+  case TYPE_INTEGER_LITERAL:
+    return a->v.integer_literal_types == b->v.integer_literal_types;
+  default:
+    return true;
+  }
+}
+
+// Returns the slot for the type, which is `NULL` if no equal type is present.
+static Type_intern **type_intern_find(Type_intern **intern, const Type *type,
+                                      Arena arena) {
+  pg_assert(intern != NULL);
+  pg_assert(type != NULL);
+
+  for (u64 hash = type_intern_hash(type); *intern != NULL; hash <<= 2) {
+    if (type_intern_eq(type, type_handle_to_ptr((*intern)->handle, arena)))
+      return intern;
+
+    intern = &(*intern)->children[hash >> 62];
+  }
+  return intern;
+}
+
+typedef struct {
+  Str file_name;
+  Str data; // As stored in the archive i.e. possibly compressed.
+  u32 uncompressed_size;
+  u16 compression_method;
+  bool loaded;
+  pg_pad(1);
+} Jar_entry;
+
+Array_struct(Jar_entry);
+
+// Class names in archives use `/` as separator but Java and Kotlin use `.`:
+// both are treated the same when hashing and comparing.
+static u64 jvm_class_name_hash(Str name) {
+  u64 hash = UT_FNV1A_OFFSET_BASIS;
+  for (u64 i = 0; i < name.len; i++) {
+    const u8 c = name.data[i] == '/' ? '.' : name.data[i];
+    hash = ut_fnv1a(hash, &c, 1);
+  }
+  return hash;
+}
+
+static bool jvm_class_names_equal(Str a, Str b) {
+  if (a.len != b.len)
+    return false;
+
+  for (u64 i = 0; i < a.len; i++) {
+    const u8 a_c = a.data[i] == '/' ? '.' : a.data[i];
+    const u8 b_c = b.data[i] == '/' ? '.' : b.data[i];
+    if (a_c != b_c)
+      return false;
+  }
+  return true;
+}
+
+// Hash trie of class name e.g. `kotlin/io/ConsoleKt` to archive entry, if any.
+typedef struct Jar_class_index Jar_class_index;
+struct Jar_class_index {
+  Jar_class_index *children[4];
+  Str class_name;
+  u32 entry_i;
+  pg_pad(4);
+};
+
+static Jar_class_index **jar_class_index_find(Jar_class_index **index,
+                                              Str class_name) {
+  pg_assert(index != NULL);
+
+  for (u64 hash = jvm_class_name_hash(class_name); *index != NULL;
+       hash <<= 2) {
+    if (jvm_class_names_equal(class_name, (*index)->class_name))
+      return index;
+
+    index = &(*index)->children[hash >> 62];
+  }
+  return index;
+}
+
+// Loading the classes of jmod and jar files is costly and done on every
+// invocation, so what the resolver keeps of each class (name, method names,
+// descriptors, flags, source location, and for InlineOnly methods the code and
+// constant pool) is stored in a cache file per archive, used as long as the
+// archive path, size and modification time are the same.
+//
+// The cache is a snapshot mapped in memory and used in place: these structures
+// are stored as is, in the native endianness, and strings are offsets into the
+// strings section. Opening it validates every offset, and loading a class
+// copies no string.
+//
+// Layout: header, classes, methods, class index, strings.
+#define CLASS_PATH_CACHE_MAGIC 0x4d4b4343 // "MKCC"
+#define CLASS_PATH_CACHE_VERSION 2
+
+// Slice of the strings section.
+typedef struct {
+  u32 offset;
+  u32 len;
+} Class_path_cache_str;
+
+typedef struct {
+  Class_path_cache_str class_name;
+  Class_path_cache_str file_name;
+  // As in a class file. Empty when no method is InlineOnly.
+  Class_path_cache_str constant_pool;
+  u32 methods_start;
+  u32 methods_len;
+} Class_path_cache_class;
+
+Array_struct(Class_path_cache_class);
+
+typedef struct {
+  Class_path_cache_str name;
+  Class_path_cache_str descriptor;
+  Class_path_cache_str source_file_name;
+  Class_path_cache_str code; // Only for InlineOnly methods.
+  u16 access_flags;
+  u16 flags;
+  u16 source_line;
+  pg_pad(2);
+} Class_path_cache_method;
+
+Array_struct(Class_path_cache_method);
+
+typedef struct {
+  u32 magic;
+  u32 version;
+  u64 archive_size;
+  u64 archive_mtime_sec;
+  u64 archive_mtime_nsec;
+  Class_path_cache_str archive_path;
+  u32 classes_len;
+  u32 methods_len;
+  // Open addressing hash table of class names to the class index + 1, 0 being
+  // an empty slot. The capacity is a power of two.
+  u32 index_cap;
+  u32 strings_len;
+} Class_path_cache_header;
+
+typedef struct {
+  const Class_path_cache_header *header;
+  const Class_path_cache_class *classes;
+  const Class_path_cache_method *methods;
+  const u32 *index;
+  u8 *strings;
+} Class_path_cache;
+
+// A jar or jmod file, kept mapped in memory so that its classes can be loaded
+// on demand. When the class path cache is used, classes are found and loaded
+// from it instead, and the archive itself is not mapped.
+typedef struct {
+  Str path;
+  Array(Jar_entry) entries;
+  Jar_class_index *class_index;
+  Class_path_cache cache;
+  bool *cache_classes_loaded;
+  bool imported_packages_loaded;
+  pg_pad(7);
+} Jar_archive;
+
+Array_struct(Jar_archive);
+
+// A directory of the class path. Its `.class` files are listed once per
+// package directory, on the first lookup of a class of this package, instead of
+// probing the file system for each class.
+typedef struct {
+  Str path;
+  Jar_class_index *class_index;     // E.g. `kotlin/io/ConsoleKt`.
+  Jar_class_index *listed_packages; // E.g. `kotlin/io`.
+} Class_path_directory;
+
+Array_struct(Class_path_directory);
+
 typedef struct {
   Type *first_type;
   Type *last_type;
+  Type_intern *types_intern;
+  Type_index *instance_types_index; // Keyed by package and class name.
+  Type_index *callables_index;      // Keyed by method name.
+  // Set while functions are generated in parallel, since they may add types.
+  pthread_mutex_t *types_lock;
 
   Parser *parser;
   Str this_class_name;
   Array(Str) class_path_entries;
+  Array(Jar_archive) archives;
+  Array(Class_path_directory) class_path_directories;
   Array(Str) imported_package_names;
   u64 class_file_loaded_count;
   Array(Type_variable) variables;
@@ -468,25 +822,16 @@ static Str codegen_make_class_name_from_path(Str path, Arena *arena);
 static Type_handle resolver_add_type(Resolver *resolver, Type *new_type,
                                      Arena *arena);
 
-static void resolver_init(Resolver *resolver, Parser *parser,
-                          Array(Str) class_path_entries, Str class_file_path,
+static void resolver_init(Resolver *resolver, Array(Str) class_path_entries,
                           Arena *arena) {
-
-  resolver->parser = parser;
-
   resolver->first_type =
       type_handle_to_ptr(new_type(&(Type){0}, arena), *arena);
   resolver->last_type = resolver->first_type;
 
   resolver->class_path_entries = class_path_entries;
-  resolver->this_class_name =
-      codegen_make_class_name_from_path(class_file_path, arena);
-  resolver->this_class_type_handle = new_type(
-      &(Type){
-          .kind = TYPE_INSTANCE,
-          .this_class_name = resolver->this_class_name,
-      },
-      arena);
+  resolver->archives = array_make(Jar_archive, 0, 16, arena);
+  resolver->class_path_directories =
+      array_make(Class_path_directory, 0, class_path_entries.len, arena);
   resolver->variables = array_make(Type_variable, 0, 512, arena);
   resolver->imported_package_names = array_make(Str, 0, 256, arena);
   *array_push(&resolver->imported_package_names, arena) = str_from_c("kotlin");
@@ -509,8 +854,40 @@ static void resolver_init(Resolver *resolver, Parser *parser,
       str_from_c("java.lang");
   *array_push(&resolver->imported_package_names, arena) =
       str_from_c("kotlin.jvm");
-  *array_push(&resolver->imported_package_names, arena) =
-      parser->current_package;
+}
+
+// Point the resolver at the source file about to be type checked. The loaded
+// types, including the function signatures of the other source files, are
+// kept.
+static void resolver_begin_file(Resolver *resolver, Source_file *source_file,
+                                Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(source_file != NULL);
+  pg_assert(arena != NULL);
+
+  resolver->parser = &source_file->parser;
+  resolver->this_class_name =
+      codegen_make_class_name_from_path(source_file->class_file_path, arena);
+  if (type_handle_handles_nil(source_file->this_class_type_handle)) {
+    source_file->this_class_type_handle = new_type(
+        &(Type){
+            .kind = TYPE_INSTANCE,
+            .this_class_name = resolver->this_class_name,
+        },
+        arena);
+  }
+  resolver->this_class_type_handle = source_file->this_class_type_handle;
+
+  const Str package_name = source_file->parser.current_package;
+  for (u64 i = 0; i < resolver->imported_package_names.len; i++) {
+    if (str_eq(resolver->imported_package_names.data[i], package_name))
+      return;
+  }
+
+  *array_push(&resolver->imported_package_names, arena) = package_name;
+  // The classes of this package, if any, still have to be loaded.
+  for (u64 i = 0; i < resolver->archives.len; i++)
+    resolver->archives.data[i].imported_packages_loaded = false;
 }
 
 static void type_init_package_and_name(Str fully_qualified_jvm_name,
@@ -556,8 +933,8 @@ static bool resolver_is_type_integer(Type_handle type, Arena arena) {
 static bool resolver_are_types_equal(const Resolver *resolver,
                                      Type_handle lhs_handle,
                                      Type_handle rhs_handle, Arena arena) {
-  if (type_handle_handles_nil(lhs_handle) &&
-      type_handle_handles_nil(rhs_handle))
+  // Types are interned, also covers the case of both being nil.
+  if (lhs_handle.value == rhs_handle.value)
     return true;
   if (type_handle_handles_nil(lhs_handle) &&
       !type_handle_handles_nil(rhs_handle))
@@ -870,7 +1247,7 @@ typedef enum __attribute__((packed)) {
 struct Jvm_constant_pool_entry {
   union {
     u64 number; // CONSTANT_POOL_KIND_INT,CONSTANT_POOL_KIND_FLOAT,CONSTANT_POOL_KIND_LONG,CONSTANT_POOL_KIND_DOUBLE
-    Str s;      // CONSTANT_POOL_KIND_UTF8
+    Str s;      // CONSTANT_POOL_KIND_UTF8, CONSTANT_POOL_KIND_UNDECODED
     u16 string_utf8_i; // CONSTANT_POOL_KIND_STRING
     u16 module;        // CONSTANT_POOL_KIND_MODULE
     u16 package;       // CONSTANT_POOL_KIND_PACKAGE
@@ -915,6 +1292,8 @@ struct Jvm_constant_pool_entry {
     CONSTANT_POOL_KIND_INVOKE_DYNAMIC = 18,
     CONSTANT_POOL_KIND_MODULE = 19,
     CONSTANT_POOL_KIND_PACKAGE = 20,
+    // Not a JVM kind: read lazily and decoded on first access.
+    CONSTANT_POOL_KIND_UNDECODED = 0xff,
   } kind;
   pg_pad(7);
 };
@@ -931,6 +1310,14 @@ struct Jvm_constant_pool {
   Jvm_constant_pool_entry *values;
 };
 
+// Hash trie of the constant pool entries, to deduplicate them when pushing.
+typedef struct Jvm_constant_pool_index Jvm_constant_pool_index;
+struct Jvm_constant_pool_index {
+  Jvm_constant_pool_index *children[4];
+  u16 constant_i;
+  pg_pad(6);
+};
+
 static bool jvm_constant_eq(const Jvm_constant_pool_entry *a,
                             const Jvm_constant_pool_entry *b) {
   if (a->kind != b->kind)
@@ -973,41 +1360,12 @@ static bool jvm_constant_eq(const Jvm_constant_pool_entry *a,
                b->v.invoke_dynamic.name_and_type_index;
   case CONSTANT_POOL_KIND_METHOD_TYPE:
     return a->v.method_type.descriptor == b->v.method_type.descriptor;
+  case CONSTANT_POOL_KIND_UNDECODED:
+    pg_assert(0 && "only decoded constants are indexed");
+    return false;
   }
 }
 
-static u16 jvm_constant_pool_push(Array(Jvm_constant_pool_entry) * pool,
-                                  const Jvm_constant_pool_entry *x,
-                                  Arena *arena) {
-  pg_assert(pool->len < UINT16_MAX);
-  pg_assert(x->kind != 0);
-
-  for (u64 i = 0; i < pool->len; i++) {
-    const Jvm_constant_pool_entry *const it = &pool->data[i];
-
-    if (jvm_constant_eq(it, x)) {
-      return (u16)(i + 1);
-    }
-
-    if (it->kind == CONSTANT_POOL_KIND_LONG ||
-        it->kind == CONSTANT_POOL_KIND_DOUBLE) {
-      // Skip incoming dummy
-      i += 1;
-    }
-  }
-
-  *array_push(pool, arena) = *x;
-  const u16 res = (u16)pool->len;
-
-  if (x->kind == CONSTANT_POOL_KIND_LONG ||
-      x->kind == CONSTANT_POOL_KIND_DOUBLE) {
-    // Dummy.
-    *array_push(pool, arena) = (Jvm_constant_pool_entry){0};
-  }
-
-  return res;
-}
-
 static void codegen_frame_init(codegen_frame *frame, Arena *arena) {
   pg_assert(frame != NULL);
   pg_assert(arena != NULL);
@@ -1022,9 +1380,9 @@ static codegen_frame *codegen_frame_clone(const codegen_frame *src,
   pg_assert(src->stack.len <= UINT16_MAX);
   pg_assert(arena != NULL);
 
+  // Right-sized, since most clones are never pushed to.
   codegen_frame *dst =
       arena_alloc(arena, sizeof(codegen_frame), _Alignof(codegen_frame), 1);
-  codegen_frame_init(dst, arena);
 
   dst->max_physical_stack = src->max_physical_stack;
   dst->max_physical_locals = src->max_physical_locals;
@@ -1038,8 +1396,16 @@ static codegen_frame *codegen_frame_clone(const codegen_frame *src,
   return dst;
 }
 
+static const Jvm_constant_pool_entry *
+jvm_constant_pool_get(Array(Jvm_constant_pool_entry) constant_pool, u16 i);
+
 static Array(Jvm_constant_pool_entry)
     jvm_constant_pool_clone(Array(Jvm_constant_pool_entry) src, Arena *arena) {
+  // The clone outlives the class file content that undecoded constants point
+  // to.
+  for (u64 i = 0; i < src.len; i++)
+    jvm_constant_pool_get(src, (u16)(i + 1));
+
   Array(Jvm_constant_pool_entry) dst = {0};
   array_clone(Jvm_constant_pool_entry, &dst, src, arena);
 
@@ -1053,11 +1419,40 @@ static Array(Jvm_constant_pool_entry)
   return dst;
 }
 
+// Where reading a class file jumps back to on malformed input.
+typedef struct {
+  jmp_buf jmp;
+  const char *message;
+  const u8 *at;
+} Jvm_read_error;
+
+// Cursor over a class file. Bounds are checked once per structure with
+// `jvm_reader_need`, and what is in bounds is then loaded without further
+// checks. Malformed input is not fatal when reading a class file:
+// `jvm_reader_fail` jumps back to `jvm_buf_read_class_file`.
+typedef struct {
+  Str buf;
+  u8 *current;
+  Jvm_read_error *on_error; // When NULL, malformed input is fatal.
+} Jvm_reader;
+
+// Decode in place a constant read lazily.
+static void jvm_constant_decode(Jvm_constant_pool_entry *constant,
+                                u16 constant_pool_count,
+                                Jvm_read_error *on_error);
+
 static const Jvm_constant_pool_entry *
 jvm_constant_pool_get(Array(Jvm_constant_pool_entry) constant_pool, u16 i) {
   // 1-indexed.
   pg_assert(i > 0);
-  return &constant_pool.data[i - 1];
+  pg_assert(i <= constant_pool.len);
+  Jvm_constant_pool_entry *const constant = &constant_pool.data[i - 1];
+
+  // Decoded once, when first accessed.
+  if (constant->kind == CONSTANT_POOL_KIND_UNDECODED)
+    jvm_constant_decode(constant, (u16)constant_pool.len, NULL);
+
+  return constant;
 }
 
 static Str_builder jvm_fill_descriptor_string(Str_builder sb,
@@ -1345,6 +1740,8 @@ struct Jvm_attribute {
         runtime_invisible_annotations; // ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS
 
     Array(u16) exception_index_table; // ATTRIBUTE_KIND_EXCEPTIONS
+
+    Str raw; // When `lazy`, see `jvm_attribute_decode`.
   } v;
   u16 name;
   enum __attribute__((packed)) Jvm_attribute_kind {
@@ -1355,7 +1752,8 @@ struct Jvm_attribute {
     ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS,
     ATTRIBUTE_KIND_EXCEPTIONS,
   } kind;
-  pg_pad(5);
+  bool lazy;
+  pg_pad(4);
 };
 
 typedef enum Jvm_attribute_kind Jvm_attribute_kind;
@@ -1374,7 +1772,7 @@ struct Jvm_method {
   Array(Jvm_attribute) attributes;
 };
 
-static const u32 jvm_MAGIC_NUMBER = 0xbebafeca;
+static const u32 jvm_MAGIC_NUMBER = 0xcafebabe;
 static const u16 jvm_MAJOR_VERSION_6 = 50;
 static const u16 jvm_MAJOR_VERSION_7 = 51;
 static const u16 jvm_MINOR_VERSION = 0;
@@ -1390,46 +1788,163 @@ struct Jvm_class_file {
   u16 super_class;
   u16 interfaces_count;
   u16 fields_count;
-  pg_pad(2);
+  // Only record where attributes and constants are when reading, and decode
+  // them on demand.
+  bool lazy_attributes;
+  bool lazy_constants;
   Array(u16) interfaces;
   Array(Jvm_field) fields;
   Array(Jvm_method) methods;
   Array(Jvm_attribute) attributes;
   Array(Jvm_constant_pool_entry) constant_pool;
+  Jvm_constant_pool_index *constant_pool_index; // Deduplicates the above.
 };
 typedef struct Jvm_class_file Class_file;
 
-static void file_write_u8(FILE *file, u8 x) {
-  pg_assert(file != NULL);
-  fwrite(&x, sizeof(x), 1, file);
+static u64 jvm_constant_hash(const Jvm_constant_pool_entry *constant) {
+  u64 hash =
+      ut_fnv1a(UT_FNV1A_OFFSET_BASIS, &constant->kind, sizeof(constant->kind));
+
+  switch (constant->kind) {
+  case CONSTANT_POOL_KIND_UTF8:
+    return ut_fnv1a(hash, constant->v.s.data, constant->v.s.len);
+  case CONSTANT_POOL_KIND_INT:
+  case CONSTANT_POOL_KIND_FLOAT:
+  case CONSTANT_POOL_KIND_LONG:
+  case CONSTANT_POOL_KIND_DOUBLE:
+    return ut_fnv1a(hash, &constant->v.number, sizeof(constant->v.number));
+  case CONSTANT_POOL_KIND_METHOD_REF:
+  case CONSTANT_POOL_KIND_FIELD_REF:
+  case CONSTANT_POOL_KIND_INTERFACE_METHOD_REF:
+    hash = ut_fnv1a(hash, &constant->v.ref.class, sizeof(u16));
+    return ut_fnv1a(hash, &constant->v.ref.name_and_type, sizeof(u16));
+  case CONSTANT_POOL_KIND_CLASS_INFO:
+    return ut_fnv1a(hash, &constant->v.java_class_name, sizeof(u16));
+  case CONSTANT_POOL_KIND_NAME_AND_TYPE:
+    hash = ut_fnv1a(hash, &constant->v.name_and_type.name, sizeof(u16));
+    return ut_fnv1a(hash, &constant->v.name_and_type.descriptor, sizeof(u16));
+  case CONSTANT_POOL_KIND_STRING:
+    return ut_fnv1a(hash, &constant->v.string_utf8_i, sizeof(u16));
+  case CONSTANT_POOL_KIND_MODULE:
+    return ut_fnv1a(hash, &constant->v.module, sizeof(u16));
+  case CONSTANT_POOL_KIND_PACKAGE:
+    return ut_fnv1a(hash, &constant->v.package, sizeof(u16));
+  case CONSTANT_POOL_KIND_METHOD_HANDLE:
+    hash = ut_fnv1a(hash, &constant->v.method_handle.reference_kind,
+                    sizeof(u8));
+    return ut_fnv1a(hash, &constant->v.method_handle.reference_index,
+                    sizeof(u16));
+  case CONSTANT_POOL_KIND_INVOKE_DYNAMIC:
+    hash = ut_fnv1a(hash,
+                    &constant->v.invoke_dynamic.bootstrap_method_attr_index,
+                    sizeof(u16));
+    return ut_fnv1a(hash, &constant->v.invoke_dynamic.name_and_type_index,
+                    sizeof(u16));
+  case CONSTANT_POOL_KIND_METHOD_TYPE:
+    return ut_fnv1a(hash, &constant->v.method_type.descriptor, sizeof(u16));
+  case CONSTANT_POOL_KIND_UNDECODED: // Only decoded constants are indexed.
+    break;
+  }
+  pg_assert(0 && "unreachable");
+}
+
+static Jvm_constant_pool_index **
+jvm_constant_pool_index_find(Jvm_constant_pool_index **index,
+                             Array(Jvm_constant_pool_entry) constant_pool,
+                             const Jvm_constant_pool_entry *constant) {
+  pg_assert(index != NULL);
+  pg_assert(constant != NULL);
+
+  for (u64 hash = jvm_constant_hash(constant); *index != NULL; hash <<= 2) {
+    if (jvm_constant_eq(
+            jvm_constant_pool_get(constant_pool, (*index)->constant_i),
+            constant))
+      return index;
+
+    index = &(*index)->children[hash >> 62];
+  }
+  return index;
+}
+
+// Append without deduplicating, when reading a class file: the indices must
+// match the file. The entry is not indexed.
+static u16 jvm_constant_pool_push_raw(Class_file *class_file,
+                                      const Jvm_constant_pool_entry *x,
+                                      Arena *arena) {
+  pg_assert(class_file != NULL);
+  pg_assert(class_file->constant_pool.len < UINT16_MAX);
+  pg_assert(x->kind != 0);
+
+  *array_push(&class_file->constant_pool, arena) = *x;
+  const u16 res = (u16)class_file->constant_pool.len;
+
+  // An undecoded constant starts with its tag.
+  const u8 kind =
+      x->kind == CONSTANT_POOL_KIND_UNDECODED ? x->v.s.data[0] : x->kind;
+  if (kind == CONSTANT_POOL_KIND_LONG || kind == CONSTANT_POOL_KIND_DOUBLE) {
+    // Dummy.
+    *array_push(&class_file->constant_pool, arena) =
+        (Jvm_constant_pool_entry){0};
+  }
+
+  return res;
+}
+
+static u16 jvm_constant_pool_push(Class_file *class_file,
+                                  const Jvm_constant_pool_entry *x,
+                                  Arena *arena) {
+  pg_assert(class_file != NULL);
+  pg_assert(class_file->constant_pool.len < UINT16_MAX);
+  pg_assert(x->kind != 0);
+
+  Jvm_constant_pool_index **const slot = jvm_constant_pool_index_find(
+      &class_file->constant_pool_index, class_file->constant_pool, x);
+  if (*slot != NULL)
+    return (*slot)->constant_i;
+
+  const u16 res = jvm_constant_pool_push_raw(class_file, x, arena);
+
+  *slot = arena_alloc(arena, sizeof(Jvm_constant_pool_index),
+                      _Alignof(Jvm_constant_pool_index), 1);
+  (*slot)->constant_i = res;
+
+  return res;
+}
+
+// Class files are serialized into an in-memory buffer, written out at once.
+static void buf_write_u8(Str_builder *out, u8 x, Arena *arena) {
+  pg_assert(out != NULL);
+
+  *out = sb_append_char(*out, x, arena);
 }
-static void file_write_be_u16(FILE *file, u16 x) {
-  pg_assert(file != NULL);
 
-  const u8 x_be[2] = {
+static void buf_write_be_u16(Str_builder *out, u16 x, Arena *arena) {
+  pg_assert(out != NULL);
+
+  u8 x_be[2] = {
       (u8)((x & (u16)0xff00) >> 8),
       (u8)((x & (u16)0x00ff) >> 0),
   };
-  fwrite(x_be, sizeof(x_be), 1, file);
+  *out = sb_append(*out, (Str){.data = x_be, .len = sizeof(x_be)}, arena);
 }
 
-static void file_write_be_u32(FILE *file, u32 x) {
-  pg_assert(file != NULL);
+static void buf_write_be_u32(Str_builder *out, u32 x, Arena *arena) {
+  pg_assert(out != NULL);
 
-  const u8 x_be[4] = {
+  u8 x_be[4] = {
       (u8)((x & 0xff000000U) >> 24),
       (u8)((x & 0x00ff0000U) >> 16),
       (u8)((x & 0x0000ff00U) >> 8),
       (u8)((x & 0x000000ffU) >> 0),
   };
-  fwrite(x_be, sizeof(x_be), 1, file);
+  *out = sb_append(*out, (Str){.data = x_be, .len = sizeof(x_be)}, arena);
 }
 
-static void file_write_be_u64(FILE *file, u64 x) {
-  pg_assert(file != NULL);
+static void buf_write_be_u64(Str_builder *out, u64 x, Arena *arena) {
+  pg_assert(out != NULL);
 
-  const u8 x_be[8] = {
-      (u8)((x & 0xfff0000000000000UL) >> 56),
+  u8 x_be[8] = {
+      (u8)((x & 0xff00000000000000UL) >> 56),
       (u8)((x & 0x00ff000000000000UL) >> 48),
       (u8)((x & 0x0000ff0000000000UL) >> 40),
       (u8)((x & 0x000000ff00000000UL) >> 32),
@@ -1438,7 +1953,17 @@ static void file_write_be_u64(FILE *file, u64 x) {
       (u8)((x & 0x000000000000ff00UL) >> 8),
       (u8)((x & 0x00000000000000ffUL) >> 0),
   };
-  fwrite(x_be, sizeof(x_be), 1, file);
+  *out = sb_append(*out, (Str){.data = x_be, .len = sizeof(x_be)}, arena);
+}
+
+// Fill in a length which is only known once what follows is written.
+static void buf_patch_be_u32(Str_builder out, u64 at, u32 x) {
+  pg_assert(at + sizeof(u32) <= out.len);
+
+  out.data[at + 0] = (u8)((x & 0xff000000U) >> 24);
+  out.data[at + 1] = (u8)((x & 0x00ff0000U) >> 16);
+  out.data[at + 2] = (u8)((x & 0x0000ff00U) >> 8);
+  out.data[at + 3] = (u8)((x & 0x000000ffU) >> 0);
 }
 
 static u16 buf_read_be_u16(Str buf, u8 **current) {
@@ -1465,18 +1990,6 @@ static u16 buf_read_le_u16(Str buf, u8 **current) {
   return x;
 }
 
-static u32 buf_read_be_u32(Str buf, u8 **current) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current + sizeof(u32) <= buf.data + buf.len);
-
-  const u8 *const ptr = *current;
-  const u32 x = ((u32)(ptr[0] & 0xff) << 24) | (((u32)(ptr[1] & 0xff)) << 16) |
-                (((u32)(ptr[2] & 0xff)) << 8) | (((u32)(ptr[3] & 0xff)) << 0);
-  *current += sizeof(u32);
-  return x;
-}
-
 static u32 buf_read_le_u32(Str buf, u8 **current) {
   pg_assert(!str_is_empty(buf));
   pg_assert(current != NULL);
@@ -1519,187 +2032,275 @@ static Str jvm_constant_pool_get_as_string(Array(Jvm_constant_pool_entry)
   return constant->v.s;
 }
 
-static void jvm_buf_read_attributes(Str buf, u8 **current,
-                                    Class_file *class_file,
-                                    Array(Jvm_attribute) * attributes,
-                                    Arena *arena);
+static u64 jvm_reader_remaining(const Jvm_reader *reader) {
+  return (u64)(reader->buf.data + reader->buf.len - reader->current);
+}
+
+__attribute__((noreturn)) static void jvm_reader_fail(Jvm_reader *reader,
+                                                      const char *message) {
+  Jvm_read_error *const error = reader->on_error;
+  if (error == NULL) {
+    fprintf(stderr, "Malformed class file: %s\n", message);
+    exit(EINVAL);
+  }
+
+  error->message = message;
+  error->at = reader->current;
+  longjmp(error->jmp, 1);
+}
+
+static void jvm_reader_need(Jvm_reader *reader, u64 n) {
+  if (n > jvm_reader_remaining(reader))
+    jvm_reader_fail(reader, "unexpected end of data");
+}
+
+static void jvm_reader_expect(Jvm_reader *reader, bool ok,
+                              const char *message) {
+  if (!ok)
+    jvm_reader_fail(reader, message);
+}
+
+// The loads are unchecked: `jvm_reader_need` must have been called before.
+static u8 jvm_reader_u8(Jvm_reader *reader) { return *reader->current++; }
+
+static u16 jvm_reader_be_u16(Jvm_reader *reader) {
+  u16 x = 0;
+  memcpy(&x, reader->current, sizeof(x));
+  reader->current += sizeof(x);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  x = __builtin_bswap16(x);
+#endif
+  return x;
+}
+
+static u32 jvm_reader_be_u32(Jvm_reader *reader) {
+  u32 x = 0;
+  memcpy(&x, reader->current, sizeof(x));
+  reader->current += sizeof(x);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  x = __builtin_bswap32(x);
+#endif
+  return x;
+}
+
+static Str jvm_reader_bytes(Jvm_reader *reader, u64 n) {
+  jvm_reader_need(reader, n);
+
+  const Str res = {.data = reader->current, .len = n};
+  reader->current += n;
+  return res;
+}
+
+// Reader of the next `n` bytes, which are skipped in `reader`. Reading past
+// them fails.
+static Jvm_reader jvm_reader_slice(Jvm_reader *reader, u64 n) {
+  Jvm_reader res = {.buf = jvm_reader_bytes(reader, n),
+                    .on_error = reader->on_error};
+  res.current = res.buf.data;
+  return res;
+}
+
+static void jvm_reader_expect_end(Jvm_reader *reader) {
+  jvm_reader_expect(reader, jvm_reader_remaining(reader) == 0,
+                    "length mismatch");
+}
+
+// 1-indexed.
+static void jvm_reader_expect_constant_index(Jvm_reader *reader, u16 i,
+                                             u64 constant_pool_len) {
+  jvm_reader_expect(reader, i > 0 && i <= constant_pool_len,
+                    "invalid constant pool index");
+}
+
+static const Jvm_constant_pool_entry *
+jvm_reader_constant(Jvm_reader *reader,
+                    Array(Jvm_constant_pool_entry) constant_pool, u16 i) {
+  jvm_reader_expect_constant_index(reader, i, constant_pool.len);
+
+  Jvm_constant_pool_entry *const constant = &constant_pool.data[i - 1];
+  if (constant->kind == CONSTANT_POOL_KIND_UNDECODED)
+    jvm_constant_decode(constant, (u16)constant_pool.len, reader->on_error);
 
-static void jvm_buf_read_sourcefile_attribute(Str buf, u8 **current,
+  return constant;
+}
+
+static Str jvm_reader_constant_string(Jvm_reader *reader,
+                                      Array(Jvm_constant_pool_entry)
+                                          constant_pool,
+                                      u16 i) {
+  const Jvm_constant_pool_entry *const constant =
+      jvm_reader_constant(reader, constant_pool, i);
+  jvm_reader_expect(reader, constant->kind == CONSTANT_POOL_KIND_UTF8,
+                    "expected a UTF8 constant");
+  return constant->v.s;
+}
+
+static void jvm_buf_read_attributes(Jvm_reader *reader, Class_file *class_file,
+                                    Array(Jvm_attribute) * attributes,
+                                    Arena *arena);
+
+static void jvm_buf_read_sourcefile_attribute(Jvm_reader *reader,
                                               Class_file *class_file,
                                               Array(Jvm_attribute) * attributes,
                                               Arena *arena) {
-
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(attributes != NULL);
 
-  const u8 *const current_start = *current;
-
+  jvm_reader_need(reader, sizeof(u16));
   Jvm_attribute_source_file source_file = {0};
-  source_file.source_file = buf_read_be_u16(buf, current);
-  pg_assert(source_file.source_file > 0);
-  pg_assert(source_file.source_file <= class_file->constant_pool.len);
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == 2);
+  source_file.source_file = jvm_reader_be_u16(reader);
+  jvm_reader_expect_constant_index(reader, source_file.source_file,
+                                   class_file->constant_pool.len);
 
   Jvm_attribute attribute = {.kind = ATTRIBUTE_KIND_SOURCE_FILE,
                              .v = {.source_file = source_file}};
   *array_push(&*attributes, arena) = attribute;
 }
 
-static void jvm_buf_read_code_attribute_exceptions(Str buf, u8 **current,
-                                                   Class_file *class_file,
+static void jvm_buf_read_code_attribute_exceptions(Jvm_reader *reader,
                                                    Array(Jvm_exception) *
                                                        exceptions,
                                                    Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(class_file != NULL);
+  pg_assert(reader != NULL);
   pg_assert(exceptions != NULL);
 
-  const u8 *const current_start = *current;
-
-  const u16 table_len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
+  jvm_reader_need(reader, table_len * sizeof(u16) * 4);
   *exceptions = array_make(Jvm_exception, 0, table_len, arena);
 
   for (u16 i = 0; i < table_len; i++) {
     Jvm_exception exception = {0};
 
-    exception.start_pc = buf_read_be_u16(buf, current);
-    exception.end_pc = buf_read_be_u16(buf, current);
-    exception.handler_pc = buf_read_be_u16(buf, current);
-    exception.catch_type = buf_read_be_u16(buf, current);
+    exception.start_pc = jvm_reader_be_u16(reader);
+    exception.end_pc = jvm_reader_be_u16(reader);
+    exception.handler_pc = jvm_reader_be_u16(reader);
+    exception.catch_type = jvm_reader_be_u16(reader);
 
     *array_push(&*exceptions, arena) = exception;
   }
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == sizeof(u16) + table_len * sizeof(u16) * 4);
 }
 
-static void jvm_buf_read_code_attribute(Str buf, u8 **current,
-                                        Class_file *class_file,
-                                        u32 attribute_len, u16 name_i,
+static void jvm_buf_read_code_attribute(Jvm_reader *reader,
+                                        Class_file *class_file, u16 name_i,
                                         Array(Jvm_attribute) * attributes,
                                         Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current + 2 <= buf.data + buf.len);
-  pg_assert(current != NULL);
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(attributes != NULL);
   pg_assert(arena != NULL);
 
-  const u8 *const current_start = *current;
-
+  jvm_reader_need(reader, sizeof(u16) * 2 + sizeof(u32));
   Jvm_attribute_code code = {0};
-  code.max_physical_stack = buf_read_be_u16(buf, current);
-  code.max_physical_locals = buf_read_be_u16(buf, current);
-  const u32 code_len = buf_read_be_u32(buf, current);
-  pg_assert(*current + code_len <= buf.data + buf.len);
-  pg_assert(code_len <= UINT16_MAX); // Actual limit per spec.
-
-  Str code_slice = buf_read_n_u8(buf, code_len, current);
-  code.bytecode = array_make_from_slice(u8, code_slice.data, code_len, arena);
-
-  jvm_buf_read_code_attribute_exceptions(buf, current, class_file,
-                                         &code.exceptions, arena);
-
-  jvm_buf_read_attributes(buf, current, class_file, &code.attributes, arena);
+  code.max_physical_stack = jvm_reader_be_u16(reader);
+  code.max_physical_locals = jvm_reader_be_u16(reader);
+  const u32 code_len = jvm_reader_be_u32(reader);
+  // Actual limit per spec.
+  jvm_reader_expect(reader, code_len <= UINT16_MAX, "code too long");
+
+  Str code_slice = jvm_reader_bytes(reader, code_len);
+  // When reading lazily, the class file content outlives what is decoded from
+  // it, so the bytecode is not copied.
+  code.bytecode = class_file->lazy_attributes
+                      ? (Array(u8)){.data = code_slice.data,
+                                    .len = code_len,
+                                    .cap = code_len}
+                      : array_make_from_slice(u8, code_slice.data, code_len,
+                                              arena);
+
+  jvm_buf_read_code_attribute_exceptions(reader, &code.exceptions, arena);
+
+  jvm_buf_read_attributes(reader, class_file, &code.attributes, arena);
 
   Jvm_attribute attribute = {
       .kind = ATTRIBUTE_KIND_CODE, .name = name_i, .v = {.code = code}};
   *array_push(&*attributes, arena) = attribute;
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
 static void
-jvm_buf_read_stack_map_table_attribute_verification_infos(Str buf, u8 **current,
+jvm_buf_read_stack_map_table_attribute_verification_infos(Jvm_reader *reader,
                                                           u16 count) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+  pg_assert(reader != NULL);
 
   for (u16 i = 0; i < count; i++) {
-    const u8 kind = buf_read_u8(buf, current);
+    jvm_reader_need(reader, sizeof(u8));
+    const u8 kind = jvm_reader_u8(reader);
 
     if (kind < 7)
       continue;
 
-    if (kind > 8)
-      pg_assert(0 && "invalid");
+    jvm_reader_expect(reader, kind <= 8, "invalid verification info");
 
-    buf_read_be_u16(buf, current);
+    jvm_reader_need(reader, sizeof(u16));
+    jvm_reader_be_u16(reader);
   }
 }
 
 static void jvm_buf_read_stack_map_table_attribute(
-    Str buf, u8 **current, u32 attribute_len, u16 name_i,
-    Array(Jvm_attribute) * attributes, Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+    Jvm_reader *reader, u16 name_i, Array(Jvm_attribute) * attributes,
+    Arena *arena) {
+  pg_assert(reader != NULL);
   pg_assert(attributes != NULL);
   pg_assert(arena != NULL);
 
-  const u8 *const current_start = *current;
-
-  const u16 len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 len = jvm_reader_be_u16(reader);
   Array(Stack_map_frame) stack_map_frames =
       array_make(Stack_map_frame, 0, len, arena);
 
   for (u16 i = 0; i < len; i++) {
+    jvm_reader_need(reader, sizeof(u8));
     Stack_map_frame stack_map_frame = {
-        .kind = buf_read_u8(buf, current),
+        .kind = jvm_reader_u8(reader),
     };
 
+    // All frames but the shortest ones start with `offset_delta`.
+    if (stack_map_frame.kind >= 247)
+      jvm_reader_need(reader, sizeof(u16));
+
     if (stack_map_frame.kind <= 63) // same_frame
     {
       stack_map_frame.offset_delta = stack_map_frame.kind;
     } else if (64 <= stack_map_frame.kind &&
                stack_map_frame.kind <= 127) { // same_locals_1_stack_item_frame
       stack_map_frame.offset_delta = stack_map_frame.kind - 64;
-      jvm_buf_read_stack_map_table_attribute_verification_infos(buf, current,
-                                                                1);
+      jvm_buf_read_stack_map_table_attribute_verification_infos(reader, 1);
 
     } else if (128 <= stack_map_frame.kind &&
                stack_map_frame.kind <= 246) { // reserved
-      pg_assert(0 && "unreachable");
+      jvm_reader_fail(reader, "reserved stack map frame kind");
     } else if (247 <= stack_map_frame.kind &&
                stack_map_frame.kind <=
                    247) { // same_locals_1_stack_item_frame_extended
-      stack_map_frame.offset_delta = buf_read_be_u16(buf, current);
-      jvm_buf_read_stack_map_table_attribute_verification_infos(buf, current,
-                                                                1);
+      stack_map_frame.offset_delta = jvm_reader_be_u16(reader);
+      jvm_buf_read_stack_map_table_attribute_verification_infos(reader, 1);
 
     } else if (248 <= stack_map_frame.kind &&
                stack_map_frame.kind <= 250) { // chop_frame
-      stack_map_frame.offset_delta = buf_read_be_u16(buf, current);
+      stack_map_frame.offset_delta = jvm_reader_be_u16(reader);
 
     } else if (251 <= stack_map_frame.kind &&
                stack_map_frame.kind <= 251) { // same_frame_extended
-      stack_map_frame.offset_delta = buf_read_be_u16(buf, current);
+      stack_map_frame.offset_delta = jvm_reader_be_u16(reader);
 
     } else if (252 <= stack_map_frame.kind &&
                stack_map_frame.kind <= 254) { // append_frame
-      stack_map_frame.offset_delta = buf_read_be_u16(buf, current);
+      stack_map_frame.offset_delta = jvm_reader_be_u16(reader);
       const u16 verification_info_count = stack_map_frame.kind - 251;
       jvm_buf_read_stack_map_table_attribute_verification_infos(
-          buf, current, verification_info_count);
+          reader, verification_info_count);
 
     } else { // full_frame_attribute
-      stack_map_frame.offset_delta = buf_read_be_u16(buf, current);
-      const u16 locals_count = buf_read_be_u16(buf, current);
-      jvm_buf_read_stack_map_table_attribute_verification_infos(buf, current,
+      stack_map_frame.offset_delta = jvm_reader_be_u16(reader);
+      jvm_reader_need(reader, sizeof(u16));
+      const u16 locals_count = jvm_reader_be_u16(reader);
+      jvm_buf_read_stack_map_table_attribute_verification_infos(reader,
                                                                 locals_count);
-      const u16 stack_items_count = buf_read_be_u16(buf, current);
+      jvm_reader_need(reader, sizeof(u16));
+      const u16 stack_items_count = jvm_reader_be_u16(reader);
       jvm_buf_read_stack_map_table_attribute_verification_infos(
-          buf, current, stack_items_count);
+          reader, stack_items_count);
     }
     *array_push(&stack_map_frames, arena) = stack_map_frame;
   }
@@ -1710,141 +2311,84 @@ static void jvm_buf_read_stack_map_table_attribute(
       .v = {.stack_map_table = stack_map_frames},
   };
   *array_push(&*attributes, arena) = attribute;
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
 static void jvm_buf_read_line_number_table_attribute(
-    Str buf, u8 **current, Class_file *class_file, u32 attribute_len,
-    Array(Jvm_attribute) * attributes, Arena *arena) {
-  pg_unused(arena);
-  pg_unused(class_file);
-
-  const u8 *const current_start = *current;
+    Jvm_reader *reader, Array(Jvm_attribute) * attributes, Arena *arena) {
+  pg_assert(reader != NULL);
+  pg_assert(attributes != NULL);
 
-  const u16 table_len = buf_read_be_u16(buf, current);
-  pg_assert(sizeof(table_len) + table_len * (sizeof(u16) + sizeof(u16)) ==
-            attribute_len);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
+  jvm_reader_need(reader, table_len * (sizeof(u16) + sizeof(u16)));
 
   Jvm_attribute attribute = {.kind = ATTRIBUTE_KIND_LINE_NUMBER_TABLE};
   attribute.v.line_number_table_entries =
       array_make(Jvm_line_number_table_entry, 0, table_len, arena);
 
   for (u16 i = 0; i < table_len; i++) {
-    Jvm_line_number_table_entry entry = {
-        .start_pc = buf_read_be_u16(buf, current),
-        .line_number = buf_read_be_u16(buf, current),
-    };
+    Jvm_line_number_table_entry entry = {0};
+    entry.start_pc = jvm_reader_be_u16(reader);
+    entry.line_number = jvm_reader_be_u16(reader);
     *array_push(&attribute.v.line_number_table_entries, arena) = entry;
   }
 
   *array_push(&*attributes, arena) = attribute;
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
-}
-
-static void jvm_buf_read_local_variable_table_attribute(Str buf, u8 **current,
-                                                        Class_file *class_file,
-                                                        u32 attribute_len,
-                                                        Arena *arena) {
-  pg_unused(arena);
-  const u8 *const current_start = *current;
-
-  const u16 table_len = buf_read_be_u16(buf, current);
-  const u16 entry_size = sizeof(u16) * 5;
-  pg_assert(sizeof(table_len) + table_len * entry_size == attribute_len);
-
-  for (u16 i = 0; i < table_len; i++) {
-    const u16 start_pc = buf_read_be_u16(buf, current);
-    pg_unused(start_pc);
-    const u16 len = buf_read_be_u16(buf, current);
-    pg_unused(len);
-    const u16 name_i = buf_read_be_u16(buf, current);
-    pg_assert(name_i > 0);
-    pg_assert(name_i <= class_file->constant_pool.len);
-
-    const u16 descriptor_i = buf_read_be_u16(buf, current);
-    pg_unused(descriptor_i);
-    const u16 idx = buf_read_be_u16(buf, current);
-    pg_unused(idx);
-
-    // TODO store.
-  }
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
-static void jvm_buf_read_local_variable_type_table_attribute(
-    Str buf, u8 **current, Class_file *class_file, u32 attribute_len,
-    Arena *arena) {
-  pg_unused(arena);
-  const u8 *const current_start = *current;
+// Shared by LocalVariableTable and LocalVariableTypeTable which only differ in
+// the meaning of the fourth field: descriptor or signature.
+static void jvm_buf_read_local_variable_table_attribute(
+    Jvm_reader *reader, Class_file *class_file) {
+  pg_assert(reader != NULL);
+  pg_assert(class_file != NULL);
 
-  const u16 table_len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
   const u16 entry_size = sizeof(u16) * 5;
-  pg_assert(sizeof(table_len) + table_len * entry_size == attribute_len);
+  jvm_reader_need(reader, table_len * entry_size);
 
   for (u16 i = 0; i < table_len; i++) {
-    const u16 start_pc = buf_read_be_u16(buf, current);
+    const u16 start_pc = jvm_reader_be_u16(reader);
     pg_unused(start_pc);
-    const u16 len = buf_read_be_u16(buf, current);
+    const u16 len = jvm_reader_be_u16(reader);
     pg_unused(len);
-    const u16 name_i = buf_read_be_u16(buf, current);
-    pg_assert(name_i > 0);
-    pg_assert(name_i <= class_file->constant_pool.len);
+    const u16 name_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_i,
+                                     class_file->constant_pool.len);
 
-    const u16 signature_i = buf_read_be_u16(buf, current);
-    pg_unused(signature_i);
-    const u16 idx = buf_read_be_u16(buf, current);
+    const u16 descriptor_or_signature_i = jvm_reader_be_u16(reader);
+    pg_unused(descriptor_or_signature_i);
+    const u16 idx = jvm_reader_be_u16(reader);
     pg_unused(idx);
 
     // TODO store.
   }
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
-static void jvm_buf_read_signature_attribute(Str buf, u8 **current,
-                                             Class_file *class_file,
-                                             u32 attribute_len, Arena *arena) {
-  pg_unused(arena);
-  pg_unused(class_file);
-
-  const u8 *const current_start = *current;
+static void jvm_buf_read_signature_attribute(Jvm_reader *reader) {
+  pg_assert(reader != NULL);
 
-  pg_assert(attribute_len == 2);
-  const u16 signature_i = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 signature_i = jvm_reader_be_u16(reader);
   pg_unused(signature_i);
   // TODO store.
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
 // TODO: store this data.
-static void jvm_buf_read_exceptions_attribute(Str buf, u8 **current,
+static void jvm_buf_read_exceptions_attribute(Jvm_reader *reader,
                                               Class_file *class_file,
-                                              u32 attribute_len,
                                               Array(Jvm_attribute) * attributes,
                                               Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(attributes != NULL);
   pg_assert(arena != NULL);
 
-  const u8 *const current_start = *current;
-
-  const u16 table_len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
   const u16 entry_size = sizeof(u16);
-  pg_assert(sizeof(table_len) + table_len * entry_size == attribute_len);
+  jvm_reader_need(reader, table_len * entry_size);
 
   Jvm_attribute attribute = {
       .kind = ATTRIBUTE_KIND_EXCEPTIONS,
@@ -1852,61 +2396,63 @@ static void jvm_buf_read_exceptions_attribute(Str buf, u8 **current,
   };
 
   for (u16 i = 0; i < table_len; i++) {
-    const u16 exception_i = buf_read_be_u16(buf, current);
-    pg_assert(exception_i > 0);
-    pg_assert(exception_i <= class_file->constant_pool.len);
+    const u16 exception_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, exception_i,
+                                     class_file->constant_pool.len);
   }
 
   *array_push(&*attributes, arena) = attribute;
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
-static void jvm_buf_read_inner_classes_attribute(Str buf, u8 **current,
-                                                 Class_file *class_file,
-                                                 u32 attribute_len,
-                                                 Arena *arena) {
-  pg_unused(arena);
-  const u8 *const current_start = *current;
+static void jvm_buf_read_inner_classes_attribute(Jvm_reader *reader,
+                                                 Class_file *class_file) {
+  pg_assert(reader != NULL);
+  pg_assert(class_file != NULL);
 
-  const u16 table_len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
   const u16 entry_size = sizeof(u16) * 4;
-  pg_assert(sizeof(table_len) + table_len * entry_size == attribute_len);
+  jvm_reader_need(reader, table_len * entry_size);
 
   for (u16 i = 0; i < table_len; i++) {
-    const u16 inner_class_info_i = buf_read_be_u16(buf, current);
-    pg_assert(inner_class_info_i > 0);
-    pg_assert(inner_class_info_i <= class_file->constant_pool.len);
+    const u16 inner_class_info_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, inner_class_info_i,
+                                     class_file->constant_pool.len);
 
-    const u16 outer_class_info_i = buf_read_be_u16(buf, current);
+    const u16 outer_class_info_i = jvm_reader_be_u16(reader);
     // Could be 0.
-    pg_assert(outer_class_info_i <= class_file->constant_pool.len);
+    jvm_reader_expect(reader,
+                      outer_class_info_i <= class_file->constant_pool.len,
+                      "invalid constant pool index");
 
-    const u16 inner_name_i = buf_read_be_u16(buf, current);
+    const u16 inner_name_i = jvm_reader_be_u16(reader);
     // Could be 0.
-    pg_assert(inner_name_i <= class_file->constant_pool.len);
+    jvm_reader_expect(reader, inner_name_i <= class_file->constant_pool.len,
+                      "invalid constant pool index");
 
-    const u16 inner_class_access_flags = buf_read_be_u16(buf, current);
+    const u16 inner_class_access_flags = jvm_reader_be_u16(reader);
     pg_unused(inner_class_access_flags);
 
     // TODO store.
   }
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
 }
 
-static void jvm_buf_read_annotation(Str buf, u8 **current,
-                                    Class_file *class_file,
-                                    Jvm_annotation *annotation, Arena *arena);
+// Annotations can be nested in element values. Bounded to avoid exhausting
+// the stack on malformed input.
+#define JVM_ANNOTATION_DEPTH_MAX 64
+
+static void jvm_buf_read_annotation(Jvm_reader *reader,
+                                    Jvm_annotation *annotation, u32 depth,
+                                    Arena *arena);
 
-static void jvm_buf_read_element_value(Str buf, u8 **current,
-                                       Class_file *class_file,
+static void jvm_buf_read_element_value(Jvm_reader *reader,
                                        Jvm_element_value *element_value,
-                                       Arena *arena) {
-  element_value->tag = buf_read_u8(buf, current);
+                                       u32 depth, Arena *arena) {
+  jvm_reader_expect(reader, depth < JVM_ANNOTATION_DEPTH_MAX,
+                    "annotation nested too deep");
+
+  jvm_reader_need(reader, sizeof(u8));
+  element_value->tag = jvm_reader_u8(reader);
   switch (element_value->tag) {
   case 'B':
   case 'C':
@@ -1916,38 +2462,42 @@ static void jvm_buf_read_element_value(Str buf, u8 **current,
   case 'S':
   case 'Z':
   case 's':
-    element_value->v.const_value_index = buf_read_be_u16(buf, current);
+    jvm_reader_need(reader, sizeof(u16));
+    element_value->v.const_value_index = jvm_reader_be_u16(reader);
     break;
 
   case 'e':
+    jvm_reader_need(reader, sizeof(u16) * 2);
     element_value->v.enum_const_value.type_name_index =
-        buf_read_be_u16(buf, current);
+        jvm_reader_be_u16(reader);
     element_value->v.enum_const_value.const_name_index =
-        buf_read_be_u16(buf, current);
+        jvm_reader_be_u16(reader);
     break;
 
   case 'c':
-    element_value->v.class_info_index = buf_read_be_u16(buf, current);
+    jvm_reader_need(reader, sizeof(u16));
+    element_value->v.class_info_index = jvm_reader_be_u16(reader);
     break;
 
   case '@': {
     element_value->v.annotation_value =
         arena_alloc(arena, sizeof(Jvm_annotation), _Alignof(Jvm_annotation), 1);
 
-    jvm_buf_read_annotation(buf, current, class_file,
-                            element_value->v.annotation_value, arena);
+    jvm_buf_read_annotation(reader, element_value->v.annotation_value,
+                            depth + 1, arena);
 
     break;
   }
 
   case '[': {
-    const u16 table_len = buf_read_be_u16(buf, current);
+    jvm_reader_need(reader, sizeof(u16));
+    const u16 table_len = jvm_reader_be_u16(reader);
     element_value->v.array_value =
         array_make(Jvm_element_value, 0, table_len, arena);
 
     for (u64 i = 0; i < table_len; i++) {
       Jvm_element_value element_value_child = {0};
-      jvm_buf_read_element_value(buf, current, class_file, &element_value_child,
+      jvm_buf_read_element_value(reader, &element_value_child, depth + 1,
                                  arena);
 
       *array_push(&element_value->v.array_value, arena) = element_value_child;
@@ -1956,38 +2506,40 @@ static void jvm_buf_read_element_value(Str buf, u8 **current,
   }
 
   default:
-    pg_assert(0 && "Unexpected value");
+    jvm_reader_fail(reader, "unexpected element value");
   }
 }
 
-static void jvm_buf_read_annotation(Str buf, u8 **current,
-                                    Class_file *class_file,
-                                    Jvm_annotation *annotation, Arena *arena) {
-
-  annotation->type_index = buf_read_be_u16(buf, current);
-  const u16 num_element_value_pairs = buf_read_be_u16(buf, current);
+static void jvm_buf_read_annotation(Jvm_reader *reader,
+                                    Jvm_annotation *annotation, u32 depth,
+                                    Arena *arena) {
+  jvm_reader_need(reader, sizeof(u16) * 2);
+  annotation->type_index = jvm_reader_be_u16(reader);
+  const u16 num_element_value_pairs = jvm_reader_be_u16(reader);
 
   annotation->element_value_pairs =
       array_make(Jvm_element_value_pair, 0, num_element_value_pairs, arena);
 
   for (u64 i = 0; i < num_element_value_pairs; i++) {
+    jvm_reader_need(reader, sizeof(u16));
     Jvm_element_value_pair element_value_pair = {
-        .element_name_index = buf_read_be_u16(buf, current),
+        .element_name_index = jvm_reader_be_u16(reader),
     };
-    jvm_buf_read_element_value(buf, current, class_file,
-                               &element_value_pair.element_value, arena);
+    jvm_buf_read_element_value(reader, &element_value_pair.element_value,
+                               depth, arena);
 
     *array_push(&annotation->element_value_pairs, arena) = element_value_pair;
   }
 }
 
 static void jvm_buf_read_runtime_invisible_annotations_attribute(
-    Str buf, u8 **current, Class_file *class_file, u32 attribute_len,
+    Jvm_reader *reader, Class_file *class_file,
     Array(Jvm_attribute) * attributes, Arena *arena) {
+  pg_assert(reader != NULL);
+  pg_assert(class_file != NULL);
 
-  const u8 *const current_start = *current;
-
-  const u16 table_len = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 table_len = jvm_reader_be_u16(reader);
 
   Jvm_attribute attribute = {
       .kind = ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS,
@@ -1997,217 +2549,257 @@ static void jvm_buf_read_runtime_invisible_annotations_attribute(
 
   for (u64 i = 0; i < table_len; i++) {
     Jvm_annotation annotation = {0};
-    jvm_buf_read_annotation(buf, current, class_file, &annotation, arena);
+    jvm_buf_read_annotation(reader, &annotation, 0, arena);
+    jvm_reader_expect_constant_index(reader, annotation.type_index,
+                                     class_file->constant_pool.len);
     *array_push(&attribute.v.runtime_invisible_annotations, arena) = annotation;
   }
   *array_push(attributes, arena) = attribute;
+}
 
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == attribute_len);
+// Only the attributes that are decoded into a `Jvm_attribute` have a kind,
+// the others are skipped.
+static bool jvm_attribute_kind_from_name(Str name, Jvm_attribute_kind *kind) {
+  if (str_eq_c(name, "SourceFile"))
+    *kind = ATTRIBUTE_KIND_SOURCE_FILE;
+  else if (str_eq_c(name, "Code"))
+    *kind = ATTRIBUTE_KIND_CODE;
+  else if (str_eq_c(name, "StackMapTable"))
+    *kind = ATTRIBUTE_KIND_STACK_MAP_TABLE;
+  else if (str_eq_c(name, "Exceptions"))
+    *kind = ATTRIBUTE_KIND_EXCEPTIONS;
+  else if (str_eq_c(name, "LineNumberTable"))
+    *kind = ATTRIBUTE_KIND_LINE_NUMBER_TABLE;
+  else if (str_eq_c(name, "RuntimeInvisibleAnnotations"))
+    *kind = ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS;
+  else
+    return false;
+
+  return true;
 }
 
-static void jvm_buf_read_attribute(Str buf, u8 **current,
-                                   Class_file *class_file,
-                                   Array(Jvm_attribute) * attributes,
-                                   Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+// `reader` spans exactly the content of the attribute.
+static void jvm_buf_read_attribute_content(Jvm_reader *reader,
+                                           Class_file *class_file, u16 name_i,
+                                           Array(Jvm_attribute) * attributes,
+                                           Arena *arena) {
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(attributes != NULL);
   pg_assert(arena != NULL);
 
-  const u16 name_i = buf_read_be_u16(buf, current);
-  pg_assert(name_i > 0);
-  const u32 size = buf_read_be_u32(buf, current);
-  pg_assert(*current + size <= buf.data + buf.len);
-
-  pg_assert(name_i <= class_file->constant_pool.len);
   Str attribute_name =
-      jvm_constant_pool_get_as_string(class_file->constant_pool, name_i);
+      jvm_reader_constant_string(reader, class_file->constant_pool, name_i);
 
   if (str_eq_c(attribute_name, "SourceFile")) {
-    pg_assert(2 == size);
-    jvm_buf_read_sourcefile_attribute(buf, current, class_file, attributes,
-                                      arena);
+    jvm_buf_read_sourcefile_attribute(reader, class_file, attributes, arena);
   } else if (str_eq_c(attribute_name, "Code")) {
-    jvm_buf_read_code_attribute(buf, current, class_file, size, name_i,
-                                attributes, arena);
+    jvm_buf_read_code_attribute(reader, class_file, name_i, attributes, arena);
   } else if (str_eq_c(attribute_name, "StackMapTable")) {
-    jvm_buf_read_stack_map_table_attribute(buf, current, size, name_i,
-                                           attributes, arena);
+    jvm_buf_read_stack_map_table_attribute(reader, name_i, attributes, arena);
   } else if (str_eq_c(attribute_name, "Exceptions")) {
-    jvm_buf_read_exceptions_attribute(buf, current, class_file, size,
-                                      attributes, arena);
+    jvm_buf_read_exceptions_attribute(reader, class_file, attributes, arena);
   } else if (str_eq_c(attribute_name, "InnerClasses")) {
-    jvm_buf_read_inner_classes_attribute(buf, current, class_file, size, arena);
-  } else if (str_eq_c(attribute_name, "EnclosingMethod")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "Synthetic")) {
-    *current += size; // TODO
+    jvm_buf_read_inner_classes_attribute(reader, class_file);
   } else if (str_eq_c(attribute_name, "Signature")) {
-    jvm_buf_read_signature_attribute(buf, current, class_file, size, arena);
-  } else if (str_eq_c(attribute_name, "SourceDebugExtension")) {
-    *current += size; // TODO
+    jvm_buf_read_signature_attribute(reader);
   } else if (str_eq_c(attribute_name, "LineNumberTable")) {
-    jvm_buf_read_line_number_table_attribute(buf, current, class_file, size,
-                                             attributes, arena);
-  } else if (str_eq_c(attribute_name, "LocalVariableTable")) {
-    jvm_buf_read_local_variable_table_attribute(buf, current, class_file, size,
-                                                arena);
-  } else if (str_eq_c(attribute_name, "LocalVariableTypeTable")) {
-    jvm_buf_read_local_variable_type_table_attribute(buf, current, class_file,
-                                                     size, arena);
-  } else if (str_eq_c(attribute_name, "Deprecated")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "RuntimeVisibleAnnotations")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "RuntimeInvisibleAnnotations")) {
-    jvm_buf_read_runtime_invisible_annotations_attribute(
-        buf, current, class_file, size, attributes, arena);
-  } else if (str_eq_c(attribute_name, "RuntimeVisibleParameterAnnotations")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "RuntimeInvisibleParameterAnnotations")) {
-    *current += size; // TODO
+    jvm_buf_read_line_number_table_attribute(reader, attributes, arena);
+  } else if (str_eq_c(attribute_name, "LocalVariableTable") ||
+             str_eq_c(attribute_name, "LocalVariableTypeTable")) {
+    jvm_buf_read_local_variable_table_attribute(reader, class_file);
   } else if (str_eq_c(attribute_name, "RuntimeInvisibleAnnotations")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "AnnotationsDefault")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "BootstrapMethods")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "NestMembers")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "NestHost")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "ConstantValue")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "Module")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "ModulePackages")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "ModuleMainClass")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "Record")) {
-    *current += size; // TODO
-  } else if (str_eq_c(attribute_name, "PermittedSubclasses")) {
-    *current += size; // TODO
+    jvm_buf_read_runtime_invisible_annotations_attribute(reader, class_file,
+                                                         attributes, arena);
   } else {
-    *current += size; // TODO
+    // TODO: EnclosingMethod, Synthetic, SourceDebugExtension, Deprecated,
+    // RuntimeVisibleAnnotations, RuntimeVisibleParameterAnnotations,
+    // RuntimeInvisibleParameterAnnotations, AnnotationsDefault,
+    // BootstrapMethods, NestMembers, NestHost, ConstantValue, Module,
+    // ModulePackages, ModuleMainClass, Record, PermittedSubclasses.
+    return;
+  }
+
+  jvm_reader_expect_end(reader);
+}
+
+static void jvm_buf_read_attribute(Jvm_reader *reader, Class_file *class_file,
+                                   Array(Jvm_attribute) * attributes,
+                                   Arena *arena) {
+  pg_assert(reader != NULL);
+  pg_assert(class_file != NULL);
+  pg_assert(attributes != NULL);
+  pg_assert(arena != NULL);
+
+  jvm_reader_need(reader, sizeof(u16) + sizeof(u32));
+  const u16 name_i = jvm_reader_be_u16(reader);
+  const u32 size = jvm_reader_be_u32(reader);
+  Jvm_reader content = jvm_reader_slice(reader, size);
+
+  if (!class_file->lazy_attributes) {
+    jvm_buf_read_attribute_content(&content, class_file, name_i, attributes,
+                                   arena);
+    return;
   }
+
+  Jvm_attribute_kind kind = 0;
+  if (!jvm_attribute_kind_from_name(
+          jvm_reader_constant_string(reader, class_file->constant_pool,
+                                     name_i),
+          &kind))
+    return;
+
+  *array_push(attributes, arena) = (Jvm_attribute){
+      .kind = kind,
+      .name = name_i,
+      .lazy = true,
+      .v.raw = content.buf,
+  };
+}
+
+// Decode an attribute recorded by a lazy read, without modifying it since the
+// class file is shared. Nested attributes, e.g. in `Code`, are in turn
+// recorded lazily. Malformed content is fatal.
+static Jvm_attribute jvm_attribute_decode(const Class_file *class_file,
+                                          const Jvm_attribute *attribute,
+                                          Arena *arena) {
+  pg_assert(class_file != NULL);
+  pg_assert(attribute != NULL);
+  pg_assert(arena != NULL);
+
+  if (!attribute->lazy)
+    return *attribute;
+
+  // The readers only need the constant pool.
+  Class_file shell = {
+      .constant_pool = class_file->constant_pool,
+      .lazy_attributes = true,
+  };
+  Jvm_reader reader = {
+      .buf = attribute->v.raw,
+      .current = attribute->v.raw.data,
+  };
+  Array(Jvm_attribute) decoded = array_make(Jvm_attribute, 0, 1, arena);
+  jvm_buf_read_attribute_content(&reader, &shell, attribute->name, &decoded,
+                                 arena);
+  pg_assert(decoded.len == 1);
+
+  return decoded.data[0];
 }
 
-static void jvm_buf_read_attributes(Str buf, u8 **current,
-                                    Class_file *class_file,
+static void jvm_buf_read_attributes(Jvm_reader *reader, Class_file *class_file,
                                     Array(Jvm_attribute) * attributes,
                                     Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(attributes != NULL);
   pg_assert(arena != NULL);
 
-  const u16 attribute_count = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 attribute_count = jvm_reader_be_u16(reader);
   *attributes = array_make(Jvm_attribute, 0, attribute_count, arena);
 
   for (u64 i = 0; i < attribute_count; i++) {
-    jvm_buf_read_attribute(buf, current, class_file, attributes, arena);
-  }
-}
-
-// Returns the number of incoming slots to skip:
-// - `1` in the case of CONSTANT_POOL_KIND_LONG or CONSTANT_POOL_KIND_DOUBLE
-// - `0` otherwise
-static u8 jvm_buf_read_constant(Str buf, u8 **current, Class_file *class_file,
-                                u16 constant_pool_count, Arena *arena) {
-  const u8 kind = buf_read_u8(buf, current);
-
-  if (!(kind == CONSTANT_POOL_KIND_UTF8 || kind == CONSTANT_POOL_KIND_INT ||
-        kind == CONSTANT_POOL_KIND_FLOAT || kind == CONSTANT_POOL_KIND_LONG ||
-        kind == CONSTANT_POOL_KIND_DOUBLE ||
-        kind == CONSTANT_POOL_KIND_CLASS_INFO ||
-        kind == CONSTANT_POOL_KIND_STRING ||
-        kind == CONSTANT_POOL_KIND_FIELD_REF ||
-        kind == CONSTANT_POOL_KIND_METHOD_REF ||
-        kind == CONSTANT_POOL_KIND_INTERFACE_METHOD_REF ||
-        kind == CONSTANT_POOL_KIND_NAME_AND_TYPE ||
-        kind == CONSTANT_POOL_KIND_METHOD_HANDLE ||
-        kind == CONSTANT_POOL_KIND_METHOD_TYPE ||
-        kind == CONSTANT_POOL_KIND_INVOKE_DYNAMIC ||
-        kind == CONSTANT_POOL_KIND_MODULE ||
-        kind == CONSTANT_POOL_KIND_PACKAGE)) {
-    fprintf(stderr, "Unknown constant kind found: offset=%lu kind=%u\n",
-            *current - buf.data - 1, kind);
-    pg_assert(0);
-  }
+    jvm_buf_read_attribute(reader, class_file, attributes, arena);
+  }
+}
+
+// Size of each constant after its tag, or only of the length prefix for
+// CONSTANT_POOL_KIND_UTF8. 0 for unknown kinds.
+static const u8 jvm_CONSTANT_SIZES[] = {
+    [CONSTANT_POOL_KIND_UTF8] = 2,
+    [CONSTANT_POOL_KIND_INT] = 4,
+    [CONSTANT_POOL_KIND_FLOAT] = 4,
+    [CONSTANT_POOL_KIND_LONG] = 8,
+    [CONSTANT_POOL_KIND_DOUBLE] = 8,
+    [CONSTANT_POOL_KIND_CLASS_INFO] = 2,
+    [CONSTANT_POOL_KIND_STRING] = 2,
+    [CONSTANT_POOL_KIND_FIELD_REF] = 4,
+    [CONSTANT_POOL_KIND_METHOD_REF] = 4,
+    [CONSTANT_POOL_KIND_INTERFACE_METHOD_REF] = 4,
+    [CONSTANT_POOL_KIND_NAME_AND_TYPE] = 4,
+    [CONSTANT_POOL_KIND_METHOD_HANDLE] = 3,
+    [CONSTANT_POOL_KIND_METHOD_TYPE] = 2,
+    [CONSTANT_POOL_KIND_INVOKE_DYNAMIC] = 4,
+    [CONSTANT_POOL_KIND_MODULE] = 2,
+    [CONSTANT_POOL_KIND_PACKAGE] = 2,
+};
 
-  switch (kind) {
-  case CONSTANT_POOL_KIND_UTF8: { // FIXME: It's actually modified utf8!
-    u16 len = buf_read_be_u16(buf, current);
+// Read the tag of a constant and check that its fixed size part is in bounds.
+static u8 jvm_reader_constant_kind(Jvm_reader *reader) {
+  jvm_reader_need(reader, sizeof(u8));
+  const u8 kind = jvm_reader_u8(reader);
+  const u8 size =
+      kind < sizeof(jvm_CONSTANT_SIZES) ? jvm_CONSTANT_SIZES[kind] : 0;
+  jvm_reader_expect(reader, size > 0, "unknown constant kind");
+  jvm_reader_need(reader, size);
 
-    u8 *const s = *current;
-    buf_read_n_u8(buf, len, current);
+  return kind;
+}
 
-    const Jvm_constant_pool_entry constant = {.kind = CONSTANT_POOL_KIND_UTF8,
-                                              .v.s = str_new(s, len)};
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
+static Jvm_constant_pool_entry
+jvm_buf_read_constant_entry(Jvm_reader *reader, u16 constant_pool_count) {
+  const u8 kind = jvm_reader_constant_kind(reader);
 
-    break;
+  switch (kind) {
+  case CONSTANT_POOL_KIND_UTF8: { // FIXME: It's actually modified utf8!
+    const u16 len = jvm_reader_be_u16(reader);
+
+    const Jvm_constant_pool_entry constant = {
+        .kind = CONSTANT_POOL_KIND_UTF8,
+        .v.s = jvm_reader_bytes(reader, len),
+    };
+    return constant;
   }
   case CONSTANT_POOL_KIND_INT:
   case CONSTANT_POOL_KIND_FLOAT: {
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
-        .v.number = buf_read_be_u32(buf, current),
+        .v.number = jvm_reader_be_u32(reader),
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_DOUBLE:
   case CONSTANT_POOL_KIND_LONG: {
-    const u32 high = buf_read_be_u32(buf, current);
-    const u32 low = buf_read_be_u32(buf, current);
+    const u32 high = jvm_reader_be_u32(reader);
+    const u32 low = jvm_reader_be_u32(reader);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
         .v.number = ((u64)high << 32) | low,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    return 1;
+    return constant;
   }
   case CONSTANT_POOL_KIND_CLASS_INFO: {
-    const u16 java_class_name_i = buf_read_be_u16(buf, current);
-    pg_assert(java_class_name_i > 0);
-    pg_assert(java_class_name_i <= constant_pool_count);
+    const u16 java_class_name_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, java_class_name_i,
+                                     constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = CONSTANT_POOL_KIND_CLASS_INFO,
         .v.java_class_name = java_class_name_i,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_STRING: {
-    const u16 utf8_i = buf_read_be_u16(buf, current);
-    pg_assert(utf8_i > 0);
-    pg_assert(utf8_i <= constant_pool_count);
+    const u16 utf8_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, utf8_i, constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = CONSTANT_POOL_KIND_STRING,
         .v.string_utf8_i = utf8_i,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_METHOD_REF:
   case CONSTANT_POOL_KIND_FIELD_REF:
   case CONSTANT_POOL_KIND_INTERFACE_METHOD_REF: {
-    const u16 class_i = buf_read_be_u16(buf, current);
-    pg_assert(class_i > 0);
-    pg_assert(class_i <= constant_pool_count);
+    const u16 class_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, class_i, constant_pool_count);
 
-    const u16 name_and_type_i = buf_read_be_u16(buf, current);
-    pg_assert(name_and_type_i > 0);
-    pg_assert(name_and_type_i <= constant_pool_count);
+    const u16 name_and_type_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_and_type_i,
+                                     constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
@@ -2217,17 +2809,14 @@ static u8 jvm_buf_read_constant(Str buf, u8 **current, Class_file *class_file,
                 .name_and_type = name_and_type_i,
             },
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_NAME_AND_TYPE: {
-    const u16 name_i = buf_read_be_u16(buf, current);
-    pg_assert(name_i > 0);
-    pg_assert(name_i <= constant_pool_count);
+    const u16 name_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_i, constant_pool_count);
 
-    const u16 descriptor_i = buf_read_be_u16(buf, current);
-    pg_assert(descriptor_i > 0);
-    pg_assert(descriptor_i <= constant_pool_count);
+    const u16 descriptor_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, descriptor_i, constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = CONSTANT_POOL_KIND_NAME_AND_TYPE,
@@ -2235,42 +2824,41 @@ static u8 jvm_buf_read_constant(Str buf, u8 **current, Class_file *class_file,
             .name = name_i,
             .descriptor = descriptor_i,
         }};
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_METHOD_HANDLE: {
+    const u8 reference_kind = jvm_reader_u8(reader);
+    jvm_reader_expect(reader, 1 <= reference_kind && reference_kind <= 9,
+                      "invalid method handle kind");
+
+    const u16 reference_index = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, reference_index,
+                                     constant_pool_count);
+
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
         .v.method_handle = {
-            .reference_kind = buf_read_u8(buf, current),
-            .reference_index = buf_read_be_u16(buf, current),
+            .reference_kind = reference_kind,
+            .reference_index = reference_index,
         }};
-    pg_assert(1 <= constant.v.method_handle.reference_kind &&
-              constant.v.method_handle.reference_kind <= 9);
-    pg_assert(constant.v.method_handle.reference_index > 0);
-    pg_assert(constant.v.method_handle.reference_index <= constant_pool_count);
-
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_METHOD_TYPE: {
-    const u16 descriptor = buf_read_be_u16(buf, current);
-    pg_assert(descriptor > 0);
-    pg_assert(descriptor <= constant_pool_count);
+    const u16 descriptor = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, descriptor, constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
         .v.method_type.descriptor = descriptor,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_INVOKE_DYNAMIC: {
-    const u16 bootstrap_method_attr_index = buf_read_be_u16(buf, current);
+    const u16 bootstrap_method_attr_index = jvm_reader_be_u16(reader);
 
-    const u16 name_and_type_index = buf_read_be_u16(buf, current);
-    pg_assert(name_and_type_index > 0);
-    pg_assert(name_and_type_index <= constant_pool_count);
+    const u16 name_and_type_index = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_and_type_index,
+                                     constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
@@ -2278,263 +2866,313 @@ static u8 jvm_buf_read_constant(Str buf, u8 **current, Class_file *class_file,
             .bootstrap_method_attr_index = bootstrap_method_attr_index,
             .name_and_type_index = name_and_type_index,
         }};
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_MODULE: {
-    const u16 name_i = buf_read_be_u16(buf, current);
-    pg_assert(name_i > 0);
-    pg_assert(name_i <= constant_pool_count);
+    const u16 name_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_i, constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
         .v.module = name_i,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   case CONSTANT_POOL_KIND_PACKAGE: {
-    const u16 name_i = buf_read_be_u16(buf, current);
-    pg_assert(name_i > 0);
-    pg_assert(name_i <= constant_pool_count);
+    const u16 name_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, name_i, constant_pool_count);
 
     const Jvm_constant_pool_entry constant = {
         .kind = kind,
         .v.package = name_i,
     };
-    jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
-    break;
+    return constant;
   }
   default:
     pg_assert(0 && "unreachable");
   }
-  return 0;
+
+  __builtin_unreachable();
+}
+
+static void jvm_constant_decode(Jvm_constant_pool_entry *constant,
+                                u16 constant_pool_count,
+                                Jvm_read_error *on_error) {
+  pg_assert(constant != NULL);
+  pg_assert(constant->kind == CONSTANT_POOL_KIND_UNDECODED);
+
+  Jvm_reader reader = {
+      .buf = constant->v.s,
+      .current = constant->v.s.data,
+      .on_error = on_error,
+  };
+  *constant = jvm_buf_read_constant_entry(&reader, constant_pool_count);
+  pg_assert(jvm_reader_remaining(&reader) == 0);
+}
+
+// Skip over a constant without decoding it, see `lazy_constants`.
+static Jvm_constant_pool_entry jvm_buf_skip_constant(Jvm_reader *reader) {
+  u8 *const start = reader->current;
+  const u8 kind = jvm_reader_constant_kind(reader);
+
+  if (kind == CONSTANT_POOL_KIND_UTF8)
+    jvm_reader_bytes(reader, jvm_reader_be_u16(reader));
+  else
+    reader->current += jvm_CONSTANT_SIZES[kind];
+
+  return (Jvm_constant_pool_entry){
+      .kind = CONSTANT_POOL_KIND_UNDECODED,
+      .v.s = str_new(start, (u64)(reader->current - start)),
+  };
 }
 
-static void jvm_buf_read_constants(Str buf, u8 **current,
-                                   Class_file *class_file,
+static void jvm_buf_read_constants(Jvm_reader *reader, Class_file *class_file,
                                    u16 constant_pool_count, Arena *arena) {
-  for (u64 i = 0; i < constant_pool_count; i++) {
-    pg_assert((u64)(*current - buf.data) < buf.len);
-    i += jvm_buf_read_constant(buf, current, class_file, constant_pool_count,
-                               arena);
-    pg_assert((u64)(*current - buf.data) <= buf.len);
+  while (class_file->constant_pool.len < constant_pool_count) {
+    const Jvm_constant_pool_entry constant =
+        class_file->lazy_constants
+            ? jvm_buf_skip_constant(reader)
+            : jvm_buf_read_constant_entry(reader, constant_pool_count);
+    // Also reserves the slot after LONG and DOUBLE constants.
+    jvm_constant_pool_push_raw(class_file, &constant, arena);
   }
-  pg_assert(constant_pool_count <= class_file->constant_pool.len);
+  jvm_reader_expect(reader,
+                    constant_pool_count == class_file->constant_pool.len,
+                    "constant pool count mismatch");
 }
 
-static void jvm_buf_read_method(Str buf, u8 **current, Class_file *class_file,
+static void jvm_buf_read_method(Jvm_reader *reader, Class_file *class_file,
                                 Arena *arena) {
+  jvm_reader_need(reader, sizeof(u16) * 3);
   Jvm_method method = {0};
-  method.access_flags = buf_read_be_u16(buf, current);
-  method.name = buf_read_be_u16(buf, current);
-  pg_assert(
-      jvm_constant_pool_get(class_file->constant_pool, method.name)->kind ==
-      CONSTANT_POOL_KIND_UTF8);
+  method.access_flags = jvm_reader_be_u16(reader);
+  method.name = jvm_reader_be_u16(reader);
+  jvm_reader_constant_string(reader, class_file->constant_pool, method.name);
 
-  method.descriptor = buf_read_be_u16(buf, current);
-  pg_assert(
-      jvm_constant_pool_get(class_file->constant_pool, method.name)->kind ==
-      CONSTANT_POOL_KIND_UTF8);
+  method.descriptor = jvm_reader_be_u16(reader);
+  jvm_reader_constant_string(reader, class_file->constant_pool,
+                             method.descriptor);
 
-  jvm_buf_read_attributes(buf, current, class_file, &method.attributes, arena);
+  jvm_buf_read_attributes(reader, class_file, &method.attributes, arena);
 
   *array_push(&class_file->methods, arena) = method;
 }
 
-static void jvm_buf_read_methods(Str buf, u8 **current, Class_file *class_file,
+static void jvm_buf_read_methods(Jvm_reader *reader, Class_file *class_file,
                                  Arena *arena) {
 
-  const u16 methods_count = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 methods_count = jvm_reader_be_u16(reader);
   class_file->methods = array_make(Jvm_method, 0, methods_count, arena);
 
   for (u64 i = 0; i < methods_count; i++) {
-    jvm_buf_read_method(buf, current, class_file, arena);
+    jvm_buf_read_method(reader, class_file, arena);
   }
 }
 
-static void jvm_buf_read_interfaces(Str buf, u8 **current,
-                                    Class_file *class_file, Arena *arena) {
-
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current != NULL);
+static void jvm_buf_read_interfaces(Jvm_reader *reader, Class_file *class_file,
+                                    Arena *arena) {
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(arena != NULL);
 
-  const u8 *const current_start = *current;
-
-  const u16 interfaces_count = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 interfaces_count = jvm_reader_be_u16(reader);
+  jvm_reader_need(reader, interfaces_count * sizeof(u16));
   class_file->interfaces = array_make(u16, 0, interfaces_count, arena);
 
   for (u16 i = 0; i < interfaces_count; i++) {
-    const u16 interface_i = buf_read_be_u16(buf, current);
-    pg_assert(interface_i > 0);
-    pg_assert(interface_i <= class_file->constant_pool.len);
+    const u16 interface_i = jvm_reader_be_u16(reader);
+    jvm_reader_expect_constant_index(reader, interface_i,
+                                     class_file->constant_pool.len);
 
     *array_push(&class_file->interfaces, arena) = interface_i;
   }
-
-  const u8 *const current_end = *current;
-  const u64 read_bytes = (u64)current_end - (u64)current_start;
-  pg_assert(read_bytes == sizeof(u16) + interfaces_count * sizeof(u16));
 }
 
-static void jvm_buf_read_field(Str buf, u8 **current, Class_file *class_file,
+static void jvm_buf_read_field(Jvm_reader *reader, Class_file *class_file,
                                Arena *arena) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current != NULL);
+  pg_assert(reader != NULL);
   pg_assert(class_file != NULL);
   pg_assert(arena != NULL);
 
+  jvm_reader_need(reader, sizeof(u16) * 3);
   Jvm_field field = {0};
-  field.access_flags = buf_read_be_u16(buf, current);
-  field.name = buf_read_be_u16(buf, current);
-  pg_assert(field.name > 0);
-  pg_assert(field.name <= class_file->constant_pool.len);
+  field.access_flags = jvm_reader_be_u16(reader);
+  field.name = jvm_reader_be_u16(reader);
+  jvm_reader_expect_constant_index(reader, field.name,
+                                   class_file->constant_pool.len);
 
-  field.descriptor = buf_read_be_u16(buf, current);
-  pg_assert(field.descriptor > 0);
-  pg_assert(field.descriptor <= class_file->constant_pool.len);
+  field.descriptor = jvm_reader_be_u16(reader);
+  jvm_reader_expect_constant_index(reader, field.descriptor,
+                                   class_file->constant_pool.len);
 
-  jvm_buf_read_attributes(buf, current, class_file, &field.attributes, arena);
+  jvm_buf_read_attributes(reader, class_file, &field.attributes, arena);
 
   *array_push(&class_file->fields, arena) = field;
 }
 
-static void jvm_buf_read_fields(Str buf, u8 **current, Class_file *class_file,
+static void jvm_buf_read_fields(Jvm_reader *reader, Class_file *class_file,
                                 Arena *arena) {
 
-  const u16 fields_count = buf_read_be_u16(buf, current);
+  jvm_reader_need(reader, sizeof(u16));
+  const u16 fields_count = jvm_reader_be_u16(reader);
   class_file->fields = array_make(Jvm_field, 0, fields_count, arena);
 
   for (u16 i = 0; i < fields_count; i++) {
-    jvm_buf_read_field(buf, current, class_file, arena);
+    jvm_buf_read_field(reader, class_file, arena);
   }
 }
 
-static void jvm_buf_read_class_file(Str buf, u8 **current,
-                                    Class_file *class_file, Arena *arena) {
-
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current != NULL);
+// Malformed content is reported and `false` is returned, with `class_file`
+// partially filled. The class file content must outlive `class_file`.
+static bool jvm_buf_read_class_file(Str buf, Class_file *class_file,
+                                    Arena *arena) {
   pg_assert(class_file != NULL);
   pg_assert(arena != NULL);
 
-  // Magic.
-  pg_assert(buf_read_u8(buf, current) == 0xca);
-  pg_assert(buf_read_u8(buf, current) == 0xfe);
-  pg_assert(buf_read_u8(buf, current) == 0xba);
-  pg_assert(buf_read_u8(buf, current) == 0xbe);
+  Jvm_read_error error = {0};
+  Jvm_reader reader = {.buf = buf, .current = buf.data, .on_error = &error};
+  if (setjmp(error.jmp) != 0) {
+    fprintf(stderr, "Malformed class file %.*s: %s at offset %lu\n",
+            (int)class_file->class_file_path.len,
+            class_file->class_file_path.data, error.message,
+            (u64)(error.at - buf.data));
+    return false;
+  }
 
-  class_file->minor_version = buf_read_be_u16(buf, current);
-  class_file->major_version = buf_read_be_u16(buf, current);
+  jvm_reader_need(&reader, sizeof(u32) + sizeof(u16) * 3);
+  jvm_reader_expect(&reader, jvm_reader_be_u32(&reader) == jvm_MAGIC_NUMBER,
+                    "invalid magic number");
 
-  u16 constant_pool_count = buf_read_be_u16(buf, current);
-  pg_assert(constant_pool_count > 0);
+  class_file->minor_version = jvm_reader_be_u16(&reader);
+  class_file->major_version = jvm_reader_be_u16(&reader);
+
+  u16 constant_pool_count = jvm_reader_be_u16(&reader);
+  jvm_reader_expect(&reader, constant_pool_count > 0,
+                    "invalid constant pool count");
   constant_pool_count -= 1; // Per spec: -1.
 
   // Worst case: only LONG or DOUBLE entries which take 2 slots.
   class_file->constant_pool =
       array_make(Jvm_constant_pool_entry, 0, constant_pool_count, arena);
 
-  jvm_buf_read_constants(buf, current, class_file, constant_pool_count, arena);
+  jvm_buf_read_constants(&reader, class_file, constant_pool_count, arena);
 
-  class_file->access_flags = buf_read_be_u16(buf, current);
+  jvm_reader_need(&reader, sizeof(u16) * 3);
+  class_file->access_flags = jvm_reader_be_u16(&reader);
 
-  class_file->this_class = buf_read_be_u16(buf, current);
-  pg_assert(class_file->this_class > 0);
-  pg_assert(class_file->this_class <= constant_pool_count);
-  const Jvm_constant_pool_entry *const this_class =
-      jvm_constant_pool_get(class_file->constant_pool, class_file->this_class);
-  pg_assert(this_class->kind == CONSTANT_POOL_KIND_CLASS_INFO);
-  class_file->class_name = jvm_constant_pool_get_as_string(
-      class_file->constant_pool, this_class->v.string_utf8_i);
+  class_file->this_class = jvm_reader_be_u16(&reader);
+  const Jvm_constant_pool_entry *const this_class = jvm_reader_constant(
+      &reader, class_file->constant_pool, class_file->this_class);
+  jvm_reader_expect(&reader, this_class->kind == CONSTANT_POOL_KIND_CLASS_INFO,
+                    "expected a class constant");
+  class_file->class_name = jvm_reader_constant_string(
+      &reader, class_file->constant_pool, this_class->v.java_class_name);
 
-  class_file->super_class = buf_read_be_u16(buf, current);
-  pg_assert(class_file->super_class <= constant_pool_count);
+  class_file->super_class = jvm_reader_be_u16(&reader);
+  // Could be 0.
+  jvm_reader_expect(&reader, class_file->super_class <= constant_pool_count,
+                    "invalid constant pool index");
 
-  jvm_buf_read_interfaces(buf, current, class_file, arena);
+  jvm_buf_read_interfaces(&reader, class_file, arena);
 
-  jvm_buf_read_fields(buf, current, class_file, arena);
+  jvm_buf_read_fields(&reader, class_file, arena);
 
-  jvm_buf_read_methods(buf, current, class_file, arena);
+  jvm_buf_read_methods(&reader, class_file, arena);
 
-  jvm_buf_read_attributes(buf, current, class_file, &class_file->attributes,
-                          arena);
+  jvm_buf_read_attributes(&reader, class_file, &class_file->attributes, arena);
+
+  jvm_reader_expect_end(&reader);
 
-  const u64 remaining = (u64)buf.data + buf.len - (u64)*current;
-  pg_assert(remaining == 0);
+  return true;
 }
 
-static void jvm_write_constant(const Class_file *class_file, FILE *file,
-                               const Jvm_constant_pool_entry *constant) {
+static void jvm_write_constant(const Class_file *class_file, Str_builder *out,
+                               const Jvm_constant_pool_entry *constant,
+                               Arena *arena) {
   pg_assert(class_file != NULL);
-  pg_assert(file != NULL);
+  pg_assert(out != NULL);
   pg_assert(constant != NULL);
 
-  fwrite(&constant->kind, sizeof(u8), 1, file);
+  buf_write_u8(out, constant->kind, arena);
   switch (constant->kind) {
   case CONSTANT_POOL_KIND_UTF8: {
     Str s = constant->v.s;
     pg_assert(s.len <= UINT16_MAX);
-    file_write_be_u16(file, (u16)s.len);
-    fwrite(s.data, sizeof(u8), s.len, file);
+    buf_write_be_u16(out, (u16)s.len, arena);
+    *out = sb_append(*out, s, arena);
     break;
   }
   case CONSTANT_POOL_KIND_FLOAT:
   case CONSTANT_POOL_KIND_INT:
     pg_assert(constant->v.number <= UINT32_MAX);
-    file_write_be_u32(file, (u32)constant->v.number);
+    buf_write_be_u32(out, (u32)constant->v.number, arena);
     break;
   case CONSTANT_POOL_KIND_LONG:
   case CONSTANT_POOL_KIND_DOUBLE:
-    file_write_be_u64(file, constant->v.number);
+    buf_write_be_u64(out, constant->v.number, arena);
     break;
 
   case CONSTANT_POOL_KIND_CLASS_INFO:
-    file_write_be_u16(file, constant->v.java_class_name);
+    buf_write_be_u16(out, constant->v.java_class_name, arena);
     break;
   case CONSTANT_POOL_KIND_STRING:
-    file_write_be_u16(file, constant->v.string_utf8_i);
+    buf_write_be_u16(out, constant->v.string_utf8_i, arena);
     break;
   case CONSTANT_POOL_KIND_FIELD_REF:
   case CONSTANT_POOL_KIND_METHOD_REF:
   case CONSTANT_POOL_KIND_INTERFACE_METHOD_REF: {
     const Jvm_constant_ref *const ref = &constant->v.ref;
 
-    file_write_be_u16(file, ref->class);
-    file_write_be_u16(file, ref->name_and_type);
+    buf_write_be_u16(out, ref->class, arena);
+    buf_write_be_u16(out, ref->name_and_type, arena);
     break;
   }
   case CONSTANT_POOL_KIND_NAME_AND_TYPE: {
     const Jvm_constant_name_and_type *const name_and_type =
         &constant->v.name_and_type;
 
-    file_write_be_u16(file, name_and_type->name);
-    file_write_be_u16(file, name_and_type->descriptor);
+    buf_write_be_u16(out, name_and_type->name, arena);
+    buf_write_be_u16(out, name_and_type->descriptor, arena);
     break;
   }
+  case CONSTANT_POOL_KIND_METHOD_HANDLE:
+    buf_write_u8(out, constant->v.method_handle.reference_kind, arena);
+    buf_write_be_u16(out, constant->v.method_handle.reference_index, arena);
+    break;
+  case CONSTANT_POOL_KIND_METHOD_TYPE:
+    buf_write_be_u16(out, constant->v.method_type.descriptor, arena);
+    break;
   case CONSTANT_POOL_KIND_INVOKE_DYNAMIC:
-    pg_assert(0 && "unimplemented");
+    buf_write_be_u16(out,
+                     constant->v.invoke_dynamic.bootstrap_method_attr_index,
+                     arena);
+    buf_write_be_u16(out, constant->v.invoke_dynamic.name_and_type_index,
+                     arena);
+    break;
+  case CONSTANT_POOL_KIND_MODULE:
+    buf_write_be_u16(out, constant->v.module, arena);
+    break;
+  case CONSTANT_POOL_KIND_PACKAGE:
+    buf_write_be_u16(out, constant->v.package, arena);
     break;
   default:
     pg_assert(0 && "unreachable/unimplemented");
   }
 }
 
-static void jvm_write_constant_pool(const Class_file *class_file, FILE *file) {
+static void jvm_write_constant_pool(const Class_file *class_file,
+                                    Str_builder *out, Arena *arena) {
   pg_assert(class_file != NULL);
-  pg_assert(file != NULL);
+  pg_assert(out != NULL);
   pg_assert(class_file->constant_pool.len < UINT16_MAX);
-  file_write_be_u16(file, (u16)class_file->constant_pool.len + 1);
+  buf_write_be_u16(out, (u16)class_file->constant_pool.len + 1, arena);
 
   for (u64 i = 0; i < class_file->constant_pool.len; i++) {
     const Jvm_constant_pool_entry *const constant =
-        &class_file->constant_pool.data[i];
-    jvm_write_constant(class_file, file, constant);
+        jvm_constant_pool_get(class_file->constant_pool, (u16)(i + 1));
+    jvm_write_constant(class_file, out, constant, arena);
     if (constant->kind == CONSTANT_POOL_KIND_LONG ||
         constant->kind == CONSTANT_POOL_KIND_DOUBLE) {
       // Skip incoming dummy
@@ -2543,67 +3181,81 @@ static void jvm_write_constant_pool(const Class_file *class_file, FILE *file) {
   }
 }
 
-static void jvm_write_interfaces(const Class_file *class_file, FILE *file) {
+static void jvm_write_interfaces(const Class_file *class_file,
+                                 Str_builder *out, Arena *arena) {
   pg_assert(class_file != NULL);
-  pg_assert(file != NULL);
+  pg_assert(out != NULL);
 
-  file_write_be_u16(file, class_file->interfaces_count);
+  buf_write_be_u16(out, class_file->interfaces_count, arena);
 
   pg_assert(class_file->interfaces_count == 0 && "unimplemented");
 }
 
-static void jvm_write_fields(const Class_file *class_file, FILE *file) {
+static void jvm_write_fields(const Class_file *class_file, Str_builder *out,
+                             Arena *arena) {
   pg_assert(class_file != NULL);
-  pg_assert(file != NULL);
+  pg_assert(out != NULL);
 
-  file_write_be_u16(file, class_file->fields_count);
+  buf_write_be_u16(out, class_file->fields_count, arena);
 
   pg_assert(class_file->fields_count == 0 && "unimplemented");
 }
 
-static u32
-jvm_compute_verification_info_size(Jvm_verification_info verification_info) {
+static void jvm_write_attributes(Str_builder *out,
+                                 Array(Jvm_attribute) attributes, Arena *arena);
+
+static void
+jvm_write_verification_info(Str_builder *out,
+                            Jvm_verification_info verification_info,
+                            Arena *arena) {
+  pg_assert(out != NULL);
   pg_assert(verification_info.kind <= 8);
 
-  return verification_info.kind < 7 ? sizeof(u8) : sizeof(u8) + sizeof(u16);
+  buf_write_u8(out, verification_info.kind, arena);
+
+  if (verification_info.kind >= 7) {
+    pg_assert(verification_info.extra_data > 0);
+    buf_write_be_u16(out, verification_info.extra_data, arena);
+  }
 }
 
-static u32
-jvm_compute_verification_infos_size(const Stack_map_frame *stack_map_frame) {
+static void
+jvm_write_stack_map_table_attribute(Str_builder *out,
+                                    const Stack_map_frame *stack_map_frame,
+                                    Arena *arena) {
+  pg_assert(out != NULL);
   pg_assert(stack_map_frame != NULL);
 
   if (stack_map_frame->kind <= 63) // same_frame
   {
-    return 0;
+    buf_write_u8(out, stack_map_frame->kind, arena);
   } else if (64 <= stack_map_frame->kind &&
              stack_map_frame->kind <= 127) { // same_locals_1_stack_item_frame
+    buf_write_u8(out, stack_map_frame->kind, arena);
     const Jvm_verification_info verification_info =
         *array_last(stack_map_frame->frame->stack);
     pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
-
-    return jvm_compute_verification_info_size(verification_info);
+    jvm_write_verification_info(out, verification_info, arena);
   } else if (128 <= stack_map_frame->kind &&
              stack_map_frame->kind <= 246) { // reserved
     pg_assert(0 && "unreachable");
   } else if (247 <= stack_map_frame->kind &&
              stack_map_frame->kind <=
                  247) { // same_locals_1_stack_item_frame_extended
-    const Jvm_verification_info verification_info =
-        *array_last(stack_map_frame->frame->stack);
-    pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
-
-    return jvm_compute_verification_info_size(verification_info);
+    pg_assert(0 && "todo");
   } else if (248 <= stack_map_frame->kind &&
              stack_map_frame->kind <= 250) { // chop_frame
-    return 0;
+    buf_write_u8(out, stack_map_frame->kind, arena);
+    buf_write_be_u16(out, stack_map_frame->offset_delta, arena);
   } else if (251 <= stack_map_frame->kind &&
              stack_map_frame->kind <= 251) { // same_frame_extended
-    return 0;
+    pg_assert(0 && "todo");
   } else if (252 <= stack_map_frame->kind &&
              stack_map_frame->kind <= 254) { // append_frame
-    const u64 count = stack_map_frame->kind - 251;
-    u32 size = 0;
+    buf_write_u8(out, stack_map_frame->kind, arena);
+    buf_write_be_u16(out, stack_map_frame->offset_delta, arena);
 
+    const u64 count = stack_map_frame->kind - 251;
     for (u64 i = stack_map_frame->frame->locals.len - count;
          i < stack_map_frame->frame->locals.len; i++) {
       const Jvm_verification_info verification_info =
@@ -2611,334 +3263,167 @@ jvm_compute_verification_infos_size(const Stack_map_frame *stack_map_frame) {
 
       pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
 
-      size += jvm_compute_verification_info_size(verification_info);
+      jvm_write_verification_info(out, verification_info, arena);
     }
 
-    return size;
   } else { // full_frame
-    u32 size = 0;
+
+    buf_write_u8(out, stack_map_frame->kind, arena);
+    buf_write_be_u16(out, stack_map_frame->offset_delta, arena);
+    pg_assert(stack_map_frame->frame->locals.len <= UINT16_MAX);
+    buf_write_be_u16(out, (u16)stack_map_frame->frame->locals.len, arena);
+
     for (u64 i = 0; i < stack_map_frame->frame->locals.len; i++) {
       const Jvm_verification_info verification_info =
           stack_map_frame->frame->locals.data[i].verification_info;
 
       pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
 
-      size += jvm_compute_verification_info_size(verification_info);
+      jvm_write_verification_info(out, verification_info, arena);
     }
 
+    pg_assert(stack_map_frame->frame->stack.len <= UINT16_MAX);
+    buf_write_be_u16(out, (u16)stack_map_frame->frame->stack.len, arena);
     for (u64 i = 0; i < stack_map_frame->frame->stack.len; i++) {
       const Jvm_verification_info verification_info =
           stack_map_frame->frame->stack.data[i];
 
       pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
 
-      size += jvm_compute_verification_info_size(verification_info);
+      jvm_write_verification_info(out, verification_info, arena);
     }
-
-    return size;
   }
-  pg_assert(0 && "unreachable");
 }
 
-static u32 jvm_compute_attribute_size(const Jvm_attribute *attribute) {
+static void jvm_write_attribute(Str_builder *out,
+                                const Jvm_attribute *attribute, Arena *arena) {
+  pg_assert(out != NULL);
   pg_assert(attribute != NULL);
 
-  switch (attribute->kind) {
-  case ATTRIBUTE_KIND_SOURCE_FILE:
-    return 2;
-  case ATTRIBUTE_KIND_CODE: {
-    const Jvm_attribute_code *const code = &attribute->v.code;
-
-    u32 size = (u32)sizeof(code->max_physical_stack) +
-               (u32)sizeof(code->max_physical_locals) + (u32)sizeof(u32) +
-               code->bytecode.len + (u32)sizeof(u16) /* exception count */ +
-               +code->exceptions.len * (u32)sizeof(Jvm_exception) +
-               (u32)sizeof(u16) // attributes length
-        ;
-
-    for (u64 i = 0; i < code->attributes.len; i++) {
-      const Jvm_attribute *const child_attribute = &code->attributes.data[i];
-      size += (u32)sizeof(u16) + (u32)sizeof(u32) +
-              jvm_compute_attribute_size(child_attribute);
-    }
-    return size;
-  }
-  case ATTRIBUTE_KIND_LINE_NUMBER_TABLE: {
-    return (u32)sizeof(u16) /* count */ +
-           attribute->v.line_number_table_entries.len *
-               (u32)sizeof(Jvm_line_number_table_entry);
-  }
-  case ATTRIBUTE_KIND_STACK_MAP_TABLE: {
-    const Array(Stack_map_frame) stack_map_frames =
-        attribute->v.stack_map_table;
-
-    u32 size = sizeof(u16) /* count */;
-    for (u16 i = 0; i < stack_map_frames.len; i++) {
-      const Stack_map_frame *const stack_map_frame = &stack_map_frames.data[i];
-
-      if (stack_map_frame->kind <= 63) // same_frame
-      {
-        size += sizeof(u8);
-      } else if (64 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <=
-                     127) { // same_locals_1_stack_item_frame
-        const u32 delta =
-            sizeof(u8) + jvm_compute_verification_infos_size(stack_map_frame);
-        pg_assert(delta >= 2);
-        pg_assert(delta <= 4);
-
-        size += delta;
-      } else if (128 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <= 246) { // reserved
-        pg_assert(0 && "unreachable");
-      } else if (247 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <=
-                     247) { // same_locals_1_stack_item_frame_extended
-        const u32 delta = sizeof(u8) + sizeof(u16) +
-                          jvm_compute_verification_infos_size(stack_map_frame);
-        pg_assert(delta >= 4);
-        pg_assert(delta <= 5);
-
-        size += delta;
-
-      } else if (248 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <= 250) { // chop_frame
-        size += sizeof(u8) + sizeof(u16);
-      } else if (251 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <= 251) { // same_frame_extended
-        size += sizeof(u8) + sizeof(u16);
-      } else if (252 <= stack_map_frame->kind &&
-                 stack_map_frame->kind <= 254) { // append_frame
-        const u32 delta = sizeof(u8) + sizeof(u16) +
-                          jvm_compute_verification_infos_size(stack_map_frame);
-
-        pg_assert(delta >= 4);
-        pg_assert(delta <= 9);
-
-        size += delta;
-      } else { // full_frame
-        size += (u32)sizeof(u8) + 3 * (u32)sizeof(u16) +
-                jvm_compute_verification_infos_size(stack_map_frame);
-      }
-    }
-
-    return size;
-  }
-  case ATTRIBUTE_KIND_EXCEPTIONS:
-    return (u32)sizeof(u16) /* count */ +
-           attribute->v.exception_index_table.len * (u32)sizeof(u16);
-  case ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS: {
-    pg_assert(0 && "todo");
-  }
-  }
-  pg_assert(0 && "unreachable");
-}
-
-static void jvm_write_attributes(FILE *file, Array(Jvm_attribute) attributes);
-
-static void
-jvm_write_verification_info(FILE *file,
-                            Jvm_verification_info verification_info) {
-  pg_assert(file != NULL);
-  pg_assert(verification_info.kind <= 8);
-
-  file_write_u8(file, verification_info.kind);
-
-  if (verification_info.kind >= 7) {
-    pg_assert(verification_info.extra_data > 0);
-    file_write_be_u16(file, verification_info.extra_data);
-  }
-}
-
-static void
-jvm_write_stack_map_table_attribute(FILE *file,
-                                    const Stack_map_frame *stack_map_frame) {
-  pg_assert(file != NULL);
-  pg_assert(stack_map_frame != NULL);
-
-  if (stack_map_frame->kind <= 63) // same_frame
-  {
-    file_write_u8(file, stack_map_frame->kind);
-  } else if (64 <= stack_map_frame->kind &&
-             stack_map_frame->kind <= 127) { // same_locals_1_stack_item_frame
-    file_write_u8(file, stack_map_frame->kind);
-    jvm_write_verification_info(file,
-                                *array_last(stack_map_frame->frame->stack));
-  } else if (128 <= stack_map_frame->kind &&
-             stack_map_frame->kind <= 246) { // reserved
-    pg_assert(0 && "unreachable");
-  } else if (247 <= stack_map_frame->kind &&
-             stack_map_frame->kind <=
-                 247) { // same_locals_1_stack_item_frame_extended
-    pg_assert(0 && "todo");
-  } else if (248 <= stack_map_frame->kind &&
-             stack_map_frame->kind <= 250) { // chop_frame
-    file_write_u8(file, stack_map_frame->kind);
-    file_write_be_u16(file, stack_map_frame->offset_delta);
-  } else if (251 <= stack_map_frame->kind &&
-             stack_map_frame->kind <= 251) { // same_frame_extended
-    pg_assert(0 && "todo");
-  } else if (252 <= stack_map_frame->kind &&
-             stack_map_frame->kind <= 254) { // append_frame
-    file_write_u8(file, stack_map_frame->kind);
-    file_write_be_u16(file, stack_map_frame->offset_delta);
-
-    const u64 count = stack_map_frame->kind - 251;
-    for (u64 i = stack_map_frame->frame->locals.len - count;
-         i < stack_map_frame->frame->locals.len; i++) {
-      const Jvm_verification_info verification_info =
-          stack_map_frame->frame->locals.data[i].verification_info;
-
-      pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
-
-      jvm_write_verification_info(file, verification_info);
-    }
-
-  } else { // full_frame
-
-    file_write_u8(file, stack_map_frame->kind);
-    file_write_be_u16(file, stack_map_frame->offset_delta);
-    pg_assert(stack_map_frame->frame->locals.len <= UINT16_MAX);
-    file_write_be_u16(file, (u16)stack_map_frame->frame->locals.len);
-
-    for (u64 i = 0; i < stack_map_frame->frame->locals.len; i++) {
-      const Jvm_verification_info verification_info =
-          stack_map_frame->frame->locals.data[i].verification_info;
-
-      pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
-
-      jvm_write_verification_info(file, verification_info);
-    }
-
-    pg_assert(stack_map_frame->frame->stack.len <= UINT16_MAX);
-    file_write_be_u16(file, (u16)stack_map_frame->frame->stack.len);
-    for (u64 i = 0; i < stack_map_frame->frame->stack.len; i++) {
-      const Jvm_verification_info verification_info =
-          stack_map_frame->frame->stack.data[i];
-
-      pg_assert(verification_info.kind != VERIFICATION_INFO_TOP);
-
-      jvm_write_verification_info(file, verification_info);
-    }
-  }
-}
-
-static void jvm_write_attribute(FILE *file, const Jvm_attribute *attribute) {
-  pg_assert(file != NULL);
-  pg_assert(attribute != NULL);
-
-  file_write_be_u16(file, attribute->name);
-
+  buf_write_be_u16(out, attribute->name, arena);
+
+  // The size is only known once the attribute is written.
+  const u64 size_at = out->len;
+  buf_write_be_u32(out, 0, arena);
+
   switch (attribute->kind) {
   case ATTRIBUTE_KIND_SOURCE_FILE: {
-    const u32 size = jvm_compute_attribute_size(attribute);
-    file_write_be_u32(file, size);
-
     const Jvm_attribute_source_file *const source_file =
         &attribute->v.source_file;
-    file_write_be_u16(file, source_file->source_file);
+    buf_write_be_u16(out, source_file->source_file, arena);
 
     break;
   }
   case ATTRIBUTE_KIND_CODE: {
-    const u32 size = jvm_compute_attribute_size(attribute);
-    file_write_be_u32(file, size);
-
     const Jvm_attribute_code *const code = &attribute->v.code;
 
-    file_write_be_u16(file, code->max_physical_stack);
+    buf_write_be_u16(out, code->max_physical_stack, arena);
 
-    file_write_be_u16(file, code->max_physical_locals);
+    buf_write_be_u16(out, code->max_physical_locals, arena);
 
     pg_assert(code->bytecode.len <= UINT32_MAX);
-    file_write_be_u32(file, code->bytecode.len);
-    fwrite(code->bytecode.data, code->bytecode.len, sizeof(u8), file);
+    buf_write_be_u32(out, code->bytecode.len, arena);
+    *out = sb_append(
+        *out, (Str){.data = code->bytecode.data, .len = code->bytecode.len},
+        arena);
 
     pg_assert(code->exceptions.len <= UINT16_MAX);
-    file_write_be_u16(file, (u16)code->exceptions.len);
+    buf_write_be_u16(out, (u16)code->exceptions.len, arena);
     pg_assert(code->exceptions.len == 0 && "todo");
 
-    jvm_write_attributes(file, code->attributes);
+    jvm_write_attributes(out, code->attributes, arena);
 
     break;
   }
   case ATTRIBUTE_KIND_LINE_NUMBER_TABLE: {
-    const u32 size = jvm_compute_attribute_size(attribute);
-    file_write_be_u32(file, size);
+    pg_assert(attribute->v.line_number_table_entries.len <= UINT16_MAX);
+    buf_write_be_u16(out, (u16)attribute->v.line_number_table_entries.len,
+                     arena);
 
     for (u16 i = 0; i < attribute->v.line_number_table_entries.len; i++) {
       Jvm_line_number_table_entry line_number_table =
           attribute->v.line_number_table_entries.data[i];
-      file_write_be_u16(file, line_number_table.start_pc);
-      file_write_be_u16(file, line_number_table.line_number);
+      buf_write_be_u16(out, line_number_table.start_pc, arena);
+      buf_write_be_u16(out, line_number_table.line_number, arena);
     }
 
     break;
   }
   case ATTRIBUTE_KIND_STACK_MAP_TABLE: {
-    const u32 size = jvm_compute_attribute_size(attribute);
-    file_write_be_u32(file, size);
-
-    file_write_be_u16(file, (u16)attribute->v.stack_map_table.len);
+    buf_write_be_u16(out, (u16)attribute->v.stack_map_table.len, arena);
 
     for (u16 i = 0; i < attribute->v.stack_map_table.len; i++) {
       const Stack_map_frame *const stack_map_frame =
           &attribute->v.stack_map_table.data[i];
-      jvm_write_stack_map_table_attribute(file, stack_map_frame);
+      jvm_write_stack_map_table_attribute(out, stack_map_frame, arena);
     }
     break;
   }
   default:
     pg_assert(0 && "unreachable");
   }
+
+  const u64 size = out->len - size_at - sizeof(u32);
+  pg_assert(size <= UINT32_MAX);
+  buf_patch_be_u32(*out, size_at, (u32)size);
 }
 
-static void jvm_write_attributes(FILE *file, Array(Jvm_attribute) attributes) {
+static void jvm_write_attributes(Str_builder *out,
+                                 Array(Jvm_attribute) attributes,
+                                 Arena *arena) {
   pg_assert(attributes.len <= UINT16_MAX);
-  file_write_be_u16(file, (u16)attributes.len);
+  buf_write_be_u16(out, (u16)attributes.len, arena);
 
   for (u64 i = 0; i < attributes.len; i++) {
     const Jvm_attribute *const attribute = &attributes.data[i];
-    jvm_write_attribute(file, attribute);
+    jvm_write_attribute(out, attribute, arena);
   }
 }
 
-static void jvm_write_method(FILE *file, const Jvm_method *method) {
-  file_write_be_u16(file, method->access_flags);
-  file_write_be_u16(file, method->name);
-  file_write_be_u16(file, method->descriptor);
+static void jvm_write_method(Str_builder *out, const Jvm_method *method,
+                             Arena *arena) {
+  buf_write_be_u16(out, method->access_flags, arena);
+  buf_write_be_u16(out, method->name, arena);
+  buf_write_be_u16(out, method->descriptor, arena);
 
-  jvm_write_attributes(file, method->attributes);
+  jvm_write_attributes(out, method->attributes, arena);
 }
 
-static void jvm_write_methods(const Class_file *class_file, FILE *file) {
+static void jvm_write_methods(const Class_file *class_file, Str_builder *out,
+                              Arena *arena) {
   pg_assert(class_file != NULL);
-  pg_assert(file != NULL);
+  pg_assert(out != NULL);
 
   pg_assert(class_file->methods.len <= UINT16_MAX);
-  file_write_be_u16(file, (u16)class_file->methods.len);
+  buf_write_be_u16(out, (u16)class_file->methods.len, arena);
 
   for (u64 i = 0; i < class_file->methods.len; i++) {
     const Jvm_method *const method = &class_file->methods.data[i];
-    jvm_write_method(file, method);
+    jvm_write_method(out, method, arena);
   }
 }
 
-static void jvm_write_class_file(const Class_file *class_file, FILE *file) {
-  fwrite(&jvm_MAGIC_NUMBER, sizeof(jvm_MAGIC_NUMBER), 1, file);
+static Str jvm_write_class_file(const Class_file *class_file, Arena *arena) {
+  pg_assert(class_file != NULL);
+  pg_assert(arena != NULL);
+
+  Str_builder out = sb_new(4 * KiB, arena);
+
+  buf_write_be_u32(&out, jvm_MAGIC_NUMBER, arena);
 
-  file_write_be_u16(file, class_file->minor_version);
-  file_write_be_u16(file, 44 + class_file->major_version);
-  jvm_write_constant_pool(class_file, file);
-  file_write_be_u16(file, class_file->access_flags);
-  file_write_be_u16(file, class_file->this_class);
-  file_write_be_u16(file, class_file->super_class);
+  buf_write_be_u16(&out, class_file->minor_version, arena);
+  buf_write_be_u16(&out, 44 + class_file->major_version, arena);
+  jvm_write_constant_pool(class_file, &out, arena);
+  buf_write_be_u16(&out, class_file->access_flags, arena);
+  buf_write_be_u16(&out, class_file->this_class, arena);
+  buf_write_be_u16(&out, class_file->super_class, arena);
 
-  jvm_write_interfaces(class_file, file);
-  jvm_write_fields(class_file, file);
-  jvm_write_methods(class_file, file);
-  jvm_write_attributes(file, class_file->attributes);
-  fflush(file);
+  jvm_write_interfaces(class_file, &out, arena);
+  jvm_write_fields(class_file, &out, arena);
+  jvm_write_methods(class_file, &out, arena);
+  jvm_write_attributes(&out, class_file->attributes, arena);
+
+  return sb_build(out);
 }
 
 static void jvm_init(Class_file *class_file, u32 methods_count, Arena *arena) {
@@ -2950,38 +3435,35 @@ static void jvm_init(Class_file *class_file, u32 methods_count, Arena *arena) {
   class_file->methods = array_make(Jvm_method, 0, methods_count, arena);
 }
 
-static u16 jvm_add_constant_string(Array(Jvm_constant_pool_entry) *
-                                       constant_pool,
-                                   Str s, Arena *arena) {
-  pg_assert(constant_pool != NULL);
+static u16 jvm_add_constant_string(Class_file *class_file, Str s,
+                                   Arena *arena) {
+  pg_assert(class_file != NULL);
   pg_assert(!str_is_empty(s));
 
   const Jvm_constant_pool_entry constant = {.kind = CONSTANT_POOL_KIND_UTF8,
                                             .v = {.s = s}};
-  return jvm_constant_pool_push(constant_pool, &constant, arena);
+  return jvm_constant_pool_push(class_file, &constant, arena);
 }
 
-static u16 jvm_add_constant_cstring(Array(Jvm_constant_pool_entry) *
-                                        constant_pool,
-                                    char *s, Arena *arena) {
-  pg_assert(constant_pool != NULL);
+static u16 jvm_add_constant_cstring(Class_file *class_file, char *s,
+                                    Arena *arena) {
+  pg_assert(class_file != NULL);
   pg_assert(s != NULL);
 
   const Jvm_constant_pool_entry constant = {.kind = CONSTANT_POOL_KIND_UTF8,
                                             .v.s = str_from_c(s)};
-  return jvm_constant_pool_push(constant_pool, &constant, arena);
+  return jvm_constant_pool_push(class_file, &constant, arena);
 }
 
-static u16 jvm_add_constant_jstring(Array(Jvm_constant_pool_entry) *
-                                        constant_pool,
-                                    u16 constant_utf8_i, Arena *arena) {
-  pg_assert(constant_pool != NULL);
+static u16 jvm_add_constant_jstring(Class_file *class_file, u16 constant_utf8_i,
+                                    Arena *arena) {
+  pg_assert(class_file != NULL);
   pg_assert(constant_utf8_i > 0);
 
   const Jvm_constant_pool_entry constant = {.kind = CONSTANT_POOL_KIND_STRING,
                                             .v.string_utf8_i = constant_utf8_i};
 
-  return jvm_constant_pool_push(constant_pool, &constant, arena);
+  return jvm_constant_pool_push(class_file, &constant, arena);
 }
 
 // TODO: sanitize `source_file_name` in case of spaces, etc.
@@ -3054,28 +3536,38 @@ static void jvm_get_source_location_of_function(const Class_file *class_file,
                                                 const Jvm_method *method,
                                                 Str *filename, u16 *line,
                                                 Arena *arena) {
-  const Jvm_attribute *const code = jvm_method_find_code_attribute(method);
-  if (code == NULL)
+  const Jvm_attribute *const code_attribute =
+      jvm_method_find_code_attribute(method);
+  if (code_attribute == NULL)
     return;
 
-  const Jvm_attribute *const source_file = jvm_attribute_by_kind(
-      code->v.code.attributes, ATTRIBUTE_KIND_SOURCE_FILE);
-  if (source_file != NULL) {
-    *filename = str_clone(
-        jvm_constant_pool_get_as_string(class_file->constant_pool,
-                                        source_file->v.source_file.source_file),
-        arena);
-  }
+  // What is decoded is only needed until the end of this function.
+  Arena tmp_arena = *arena;
+  const Jvm_attribute code =
+      jvm_attribute_decode(class_file, code_attribute, &tmp_arena);
 
   const Jvm_attribute *const line_number_table = jvm_attribute_by_kind(
-      code->v.code.attributes, ATTRIBUTE_KIND_LINE_NUMBER_TABLE);
+      code.v.code.attributes, ATTRIBUTE_KIND_LINE_NUMBER_TABLE);
   if (line_number_table != NULL) {
     const Array(Jvm_line_number_table_entry) entries =
-        line_number_table->v.line_number_table_entries;
+        jvm_attribute_decode(class_file, line_number_table, &tmp_arena)
+            .v.line_number_table_entries;
 
     if (entries.len > 0)
       *line = entries.data[0].line_number;
   }
+
+  const Jvm_attribute *const source_file = jvm_attribute_by_kind(
+      code.v.code.attributes, ATTRIBUTE_KIND_SOURCE_FILE);
+  if (source_file != NULL) {
+    const u16 source_file_i =
+        jvm_attribute_decode(class_file, source_file, &tmp_arena)
+            .v.source_file.source_file;
+    *filename = str_clone(
+        jvm_constant_pool_get_as_string(class_file->constant_pool,
+                                        source_file_i),
+        arena);
+  }
 }
 
 // ---------------------------------- Lexer
@@ -3106,18 +3598,6 @@ static u8 lex_peek(Str buf, u8 **current) {
   return lex_is_at_end(buf, current) ? 0 : **current;
 }
 
-static u8 lex_peek_next(Str buf, u8 **current) {
-  pg_assert(!str_is_empty(buf));
-  pg_assert(current != NULL);
-  pg_assert(*current != NULL);
-
-  u64 remaining = buf.len - lex_get_current_offset(buf, current);
-  if (remaining < 1)
-    return 0;
-
-  return *(*current + 1);
-}
-
 static u8 lex_advance(Str buf, u8 **current) {
   pg_assert(!str_is_empty(buf));
   pg_assert(current != NULL);
@@ -3141,25 +3621,30 @@ static bool lex_match(Str buf, u8 **current, u8 c) {
   return false;
 }
 
+// `memchr` is already vectorized by the libc, so it does the scanning here.
 static void lex_skip_until_incl_1(Str buf, u8 **current, u8 c) {
-  while (!(lex_is_at_end(buf, current) || lex_peek(buf, current) == c)) {
-    lex_advance(buf, current);
-  }
+  const u32 offset = lex_get_current_offset(buf, current);
+  u8 *found = memchr(*current, c, buf.len - offset);
+
+  *current = found != NULL ? found : &buf.data[buf.len];
 }
 
 static void lex_skip_until_incl_2(Str buf, u8 **current, u8 c1, u8 c2) {
-  while (
-      !(lex_is_at_end(buf, current) ||
-        (lex_peek(buf, current) == c1 && lex_peek_next(buf, current) == c2))) {
-    lex_advance(buf, current);
-  }
+  u8 *const end = &buf.data[buf.len];
 
-  if (!lex_is_at_end(buf, current)) {
-    pg_assert(lex_peek(buf, current) == c1 &&
-              lex_peek_next(buf, current) == c2);
-    lex_advance(buf, current);
-    lex_advance(buf, current);
+  while (*current < end) {
+    u8 *found = memchr(*current, c1, (u64)(end - *current));
+    if (found == NULL)
+      break;
+
+    if (found + 1 < end && found[1] == c2) {
+      *current = found + 2;
+      return;
+    }
+    *current = found + 1;
   }
+
+  *current = end;
 }
 
 static bool lex_is_digit(u8 c) { return ('0' <= c && c <= '9'); }
@@ -3168,6 +3653,150 @@ static bool lex_is_identifier_char(u8 c) {
   return ut_char_is_alphabetic(c) || lex_is_digit(c) || c == '_';
 }
 
+#ifdef __SSE2__
+// Lanes where `lo <= c && c <= hi`, as unsigned bytes, are all ones.
+static __m128i lex_simd_in_range(__m128i chunk, u8 lo, u8 hi) {
+  pg_assert(lo <= hi);
+
+  const __m128i rebased = _mm_sub_epi8(chunk, _mm_set1_epi8((char)lo));
+  const __m128i above =
+      _mm_subs_epu8(rebased, _mm_set1_epi8((char)(u8)(hi - lo)));
+  return _mm_cmpeq_epi8(above, _mm_setzero_si128());
+}
+
+// Bit `i` is set when `chunk[i]` is an identifier character.
+static u32 lex_simd_identifier_mask(__m128i chunk) {
+  const __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+  const __m128i alpha = lex_simd_in_range(lower, 'a', 'z');
+  const __m128i digit = lex_simd_in_range(chunk, '0', '9');
+  const __m128i underscore = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'));
+
+  return (u32)_mm_movemask_epi8(
+      _mm_or_si128(_mm_or_si128(alpha, digit), underscore));
+}
+#endif
+
+// Offset of the first byte at or after `offset` which is not an identifier
+// character, or `buf.len`. Whole 16 byte chunks are classified at once when
+// SSE2 is available, the tail byte by byte.
+static u32 lex_scan_identifier_end(Str buf, u32 offset) {
+  pg_assert(offset <= buf.len);
+
+#ifdef __SSE2__
+  while (offset + 16 <= buf.len) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)&buf.data[offset]);
+    const u32 others = ~lex_simd_identifier_mask(chunk) & 0xffff;
+    if (others != 0)
+      return offset + (u32)__builtin_ctz(others);
+
+    offset += 16;
+  }
+#endif
+
+  while (offset < buf.len && lex_is_identifier_char(buf.data[offset]))
+    offset += 1;
+
+  return offset;
+}
+
+// Estimate the number of tokens and count the newlines in one pass, to size the
+// token and line tables. Every non blank byte is counted, except identifier
+// characters which continue an identifier, so identifiers, keywords and numbers
+// count once and punctuation once per byte. Strings and comments make it an
+// over-estimate; the rare `1Lx` an under-estimate, in which case the token
+// table grows as usual.
+static void lex_estimate_counts(Str buf, u32 *tokens_estimate,
+                                u32 *newlines_count) {
+  pg_assert(tokens_estimate != NULL);
+  pg_assert(newlines_count != NULL);
+
+  u32 tokens = 0, newlines = 0;
+  bool previous_is_identifier_char = false;
+  u64 offset = 0;
+
+#ifdef __SSE2__
+  for (; offset + 16 <= buf.len; offset += 16) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)&buf.data[offset]);
+    const u32 newline_mask =
+        (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+    const u32 space_mask =
+        (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+    const u32 identifier_mask = lex_simd_identifier_mask(chunk);
+    const u32 continued_mask =
+        identifier_mask &
+        ((identifier_mask << 1) | (u32)previous_is_identifier_char);
+    const u32 starts_mask =
+        ~(newline_mask | space_mask | continued_mask) & 0xffff;
+
+    tokens += (u32)__builtin_popcount(starts_mask);
+    newlines += (u32)__builtin_popcount(newline_mask);
+    previous_is_identifier_char = (identifier_mask >> 15) & 1;
+  }
+#endif
+
+  for (; offset < buf.len; offset++) {
+    const u8 c = buf.data[offset];
+    const bool is_identifier_char = lex_is_identifier_char(c);
+
+    if (c == '\n')
+      newlines += 1;
+    else if (c != ' ' && !(is_identifier_char && previous_is_identifier_char))
+      tokens += 1;
+
+    previous_is_identifier_char = is_identifier_char;
+  }
+
+  *tokens_estimate = tokens;
+  *newlines_count = newlines;
+}
+
+static void lex_record_line_start(Lexer *lexer, Str buf, u32 offset,
+                                  Arena *arena) {
+  if (offset < buf.len)
+    *array_push(&lexer->line_table, arena) = offset;
+}
+
+// Skip a run of spaces and newlines starting at `offset` and record the start
+// of each new line in the line table. Returns the offset of the first other
+// byte, or `buf.len`.
+static u32 lex_skip_blanks(Lexer *lexer, Str buf, u32 offset, Arena *arena) {
+  pg_assert(lexer != NULL);
+  pg_assert(offset <= buf.len);
+
+#ifdef __SSE2__
+  while (offset + 16 <= buf.len) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)&buf.data[offset]);
+    const u32 newlines =
+        (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')));
+    const u32 spaces =
+        (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')));
+    const u32 others = ~(newlines | spaces) & 0xffff;
+    const u32 run_len = others == 0 ? 16 : (u32)__builtin_ctz(others);
+
+    u32 run_newlines = newlines & ((1U << run_len) - 1);
+    while (run_newlines != 0) {
+      const u32 i = (u32)__builtin_ctz(run_newlines);
+      lex_record_line_start(lexer, buf, offset + i + 1, arena);
+      run_newlines &= run_newlines - 1;
+    }
+
+    offset += run_len;
+    if (others != 0)
+      return offset;
+  }
+#endif
+
+  for (; offset < buf.len; offset++) {
+    const u8 c = buf.data[offset];
+    if (c == '\n')
+      lex_record_line_start(lexer, buf, offset + 1, arena);
+    else if (c != ' ')
+      break;
+  }
+
+  return offset;
+}
+
 static u32 lex_number_length(Str buf, u32 current_offset) {
   pg_assert(current_offset < buf.len);
 
@@ -3215,23 +3844,12 @@ static u32 lex_identifier_length(Str buf, u32 current_offset) {
   pg_assert(current_offset < buf.len);
 
   const u32 start_offset = current_offset;
-  u8 *current = &buf.data[current_offset];
-  pg_assert(ut_char_is_alphabetic(*current));
-
-  lex_advance(buf, &current);
-
-  while (!lex_is_at_end(buf, &current)) {
-    const u8 c = lex_peek(buf, &current);
-
-    if (!lex_is_identifier_char(c))
-      break;
-    lex_advance(buf, &current);
-  }
+  pg_assert(ut_char_is_alphabetic(buf.data[current_offset]));
 
-  pg_assert(!lex_is_at_end(buf, &current));
-  pg_assert(!lex_is_identifier_char(lex_peek(buf, &current)));
+  const u32 end_offset_excl = lex_scan_identifier_end(buf, start_offset + 1);
+  pg_assert(end_offset_excl < buf.len);
+  pg_assert(!lex_is_identifier_char(buf.data[end_offset_excl]));
 
-  const u32 end_offset_excl = lex_get_current_offset(buf, &current);
   pg_assert(end_offset_excl > start_offset);
   pg_assert(end_offset_excl <= buf.len);
 
@@ -3241,6 +3859,57 @@ static u32 lex_identifier_length(Str buf, u32 current_offset) {
   return len;
 }
 
+// Keywords are told apart by length and first character so that at most one
+// comparison is done per identifier.
+static Token_kind lex_keyword_kind(Str identifier) {
+  pg_assert(!str_is_empty(identifier));
+
+  Token_kind kind = TOKEN_KIND_IDENTIFIER;
+  Str keyword = {0};
+
+  switch (identifier.len) {
+  case 2:
+    kind = TOKEN_KIND_KEYWORD_IF;
+    keyword = str_from_c("if");
+    break;
+  case 3:
+    if (identifier.data[0] == 'f') {
+      kind = TOKEN_KIND_KEYWORD_FUN;
+      keyword = str_from_c("fun");
+    } else if (identifier.data[0] == 'v') {
+      kind = TOKEN_KIND_KEYWORD_VAR;
+      keyword = str_from_c("var");
+    }
+    break;
+  case 4:
+    if (identifier.data[0] == 't') {
+      kind = TOKEN_KIND_KEYWORD_TRUE;
+      keyword = str_from_c("true");
+    } else if (identifier.data[0] == 'e') {
+      kind = TOKEN_KIND_KEYWORD_ELSE;
+      keyword = str_from_c("else");
+    }
+    break;
+  case 5:
+    if (identifier.data[0] == 'f') {
+      kind = TOKEN_KIND_KEYWORD_FALSE;
+      keyword = str_from_c("false");
+    } else if (identifier.data[0] == 'w') {
+      kind = TOKEN_KIND_KEYWORD_WHILE;
+      keyword = str_from_c("while");
+    }
+    break;
+  case 6:
+    kind = TOKEN_KIND_KEYWORD_RETURN;
+    keyword = str_from_c("return");
+    break;
+  default:
+    return TOKEN_KIND_IDENTIFIER;
+  }
+
+  return str_eq(identifier, keyword) ? kind : TOKEN_KIND_IDENTIFIER;
+}
+
 static void lex_identifier(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
   pg_assert(lexer != NULL);
   pg_assert(current != NULL);
@@ -3251,61 +3920,12 @@ static void lex_identifier(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
   const u32 start_offset = lex_get_current_offset(buf, current);
   Str identifier = str_new(*current, lex_identifier_length(buf, start_offset));
   *current += identifier.len;
-  if (str_eq_c(identifier, "fun")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_FUN,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "true")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_TRUE,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "false")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_FALSE,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "var")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_VAR,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "if")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_IF,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "else")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_ELSE,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "while")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_WHILE,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else if (str_eq_c(identifier, "return")) {
-    const Token token = {
-        .kind = TOKEN_KIND_KEYWORD_RETURN,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  } else {
-    const Token token = {
-        .kind = TOKEN_KIND_IDENTIFIER,
-        .source_offset = start_offset,
-    };
-    *array_push(&lexer->tokens, arena) = token;
-  }
+
+  const Token token = {
+      .kind = lex_keyword_kind(identifier),
+      .source_offset = start_offset,
+  };
+  *array_push(&lexer->tokens, arena) = token;
 }
 
 static void lex_number(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
@@ -3341,11 +3961,14 @@ static void lex_lex(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
   pg_assert(current != NULL);
   pg_assert(*current != NULL);
 
+  u32 tokens_estimate = 0, newlines_count = 0;
+  lex_estimate_counts(buf, &tokens_estimate, &newlines_count);
+
   // tokens[0] is a dummy token.
-  lexer->tokens = array_make(Token, 1, (u32)buf.len, arena);
+  lexer->tokens = array_make(Token, 1, 1 + tokens_estimate, arena);
 
-  // First line is 0.
-  lexer->line_table = array_make(u32, 1, (u32)buf.len, arena);
+  // First line is 0, and the last entry is `buf.len`.
+  lexer->line_table = array_make(u32, 1, newlines_count + 2, arena);
 
   while (!lex_is_at_end(buf, current)) {
     const u8 c = **current;
@@ -3455,7 +4078,17 @@ static void lex_lex(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
       if (lex_match(buf, current, '/')) { // Line comment.
         lex_skip_until_incl_1(buf, current, '\n');
       } else if (lex_match(buf, current, '*')) { // Delimited comment.
+        u8 *const comment_start = *current;
         lex_skip_until_incl_2(buf, current, '*', '/');
+
+        // Lines still start inside the comment.
+        u8 *newline = comment_start;
+        while ((newline = memchr(newline, '\n',
+                                 (u64)(*current - newline))) != NULL) {
+          newline += 1;
+          const u32 offset = lex_get_current_offset(buf, &newline);
+          lex_record_line_start(lexer, buf, offset, arena);
+        }
       } else {
         const Token token = {
             .kind = TOKEN_KIND_SLASH,
@@ -3583,23 +4216,17 @@ static void lex_lex(Lexer *lexer, Str buf, u8 **current, Arena *arena) {
       };
       pg_assert(buf.data[token.source_offset - 1] == '"');
 
-      while (!lex_match(buf, current, '"')) {
-        lex_advance(buf, current);
-      }
+      // Skip the content and the closing quote.
+      *current += lex_string_length(buf, token.source_offset) + 1;
       *array_push(&lexer->tokens, arena) = token;
       break;
     }
-    case '\n': {
-      lex_advance(buf, current);
-
-      if (!lex_is_at_end(buf, current))
-        *array_push(&lexer->line_table, arena) =
-            lex_get_current_offset(buf, current);
-
-      break;
-    }
+    case '\n':
     case ' ': {
-      lex_advance(buf, current);
+      const u32 offset =
+          lex_skip_blanks(lexer, buf, lex_get_current_offset(buf, current),
+                          arena);
+      *current = &buf.data[offset];
       break;
     }
     default: {
@@ -3679,14 +4306,58 @@ static u32 lex_find_token_length(const Lexer *lexer, Str buf, Token token) {
   __builtin_unreachable();
 }
 
-// ------------------------------ Parser
+// Index in the line table of the line containing `offset`, i.e. the first `i`
+// such that `offset <= line_table[i+1]`.
+static u32 lex_find_line_index(const Lexer *lexer, u32 offset) {
+  pg_assert(lexer != NULL);
+  pg_assert(lexer->line_table.len > 1);
+  pg_assert(offset <= *array_last(lexer->line_table));
+
+  u32 low = 0, high = lexer->line_table.len - 2;
+  while (low < high) {
+    const u32 mid = low + (high - low) / 2;
+    if (lexer->line_table.data[mid + 1] < offset)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+
+  return low;
+}
 
-static void ut_fwrite_indent(FILE *file, u16 indent) {
-  for (u16 i = 0; i < indent; i++) {
-    fputc(' ', file);
+// Same as `lex_find_line_index`, for callers visiting offsets mostly in
+// increasing order: the few lines following the one found last time, stored in
+// `cursor`, are tried first before falling back to the binary search.
+static u32 lex_find_line_index_from(const Lexer *lexer, u32 *cursor,
+                                    u32 offset) {
+  pg_assert(lexer != NULL);
+  pg_assert(cursor != NULL);
+  pg_assert(lexer->line_table.len > 1);
+  pg_assert(*cursor <= lexer->line_table.len - 2);
+  pg_assert(offset <= *array_last(lexer->line_table));
+
+  const u32 *const lines = lexer->line_table.data;
+  u32 i = *cursor;
+  // Going backwards.
+  if (i > 0 && offset <= lines[i]) {
+    *cursor = lex_find_line_index(lexer, offset);
+    return *cursor;
+  }
+
+  // The last entry is the end of the source, so `i + 1` stays in bounds.
+  for (u32 steps = 0; steps < 8; steps++, i++) {
+    if (offset <= lines[i + 1]) {
+      *cursor = i;
+      return i;
+    }
   }
+
+  *cursor = lex_find_line_index(lexer, offset);
+  return *cursor;
 }
 
+// ------------------------------ Parser
+
 static void parser_find_token_position(const Parser *parser, Token token,
                                        u32 *line, u32 *column,
                                        Str *token_string) {
@@ -3703,18 +4374,12 @@ static void parser_find_token_position(const Parser *parser, Token token,
       .len = lex_find_token_length(parser->lexer, parser->buf, token),
   };
 
-  for (u32 i = 0; i < parser->lexer->line_table.len - 1; i++) {
-    const u32 line_start_offset = parser->lexer->line_table.data[i];
-    const u32 line_end_offset_excl = parser->lexer->line_table.data[i + 1];
-    if (line_start_offset <= token.source_offset &&
-        token.source_offset <= line_end_offset_excl) {
-      *line = i + 1;
-      *column = 1 + token.source_offset - line_start_offset;
+  const u32 i = lex_find_line_index(parser->lexer, token.source_offset);
+  const u32 line_start_offset = parser->lexer->line_table.data[i];
+  pg_assert(line_start_offset <= token.source_offset);
 
-      return;
-    }
-  }
-  pg_assert(*line <= parser->lexer->line_table.len);
+  *line = i + 1;
+  *column = 1 + token.source_offset - line_start_offset;
 }
 
 static char *typechecker_type_kind_string(Type_handle type_handle,
@@ -5022,14 +5687,13 @@ static Ast_handle parser_parse(Parser *parser, Arena *arena) {
   return root_i;
 }
 
-static void parser_ast_fprint(const Parser *parser, Ast_handle ast_handle,
-                              FILE *file, u16 indent, u32 count, Arena arena) {
+static void parser_ast_print(const Parser *parser, Ast_handle ast_handle,
+                             Str_builder *out, Arena *out_arena, u16 indent,
+                             u32 count, Arena arena) {
   pg_assert(parser != NULL);
   pg_assert(parser->lexer != NULL);
   pg_assert(parser->tokens_i <= parser->lexer->tokens.len);
-
-  if (!cli_log_verbose)
-    return;
+  pg_assert(out != NULL);
 
   if (ast_handle_is_nil(ast_handle))
     return;
@@ -5040,74 +5704,173 @@ static void parser_ast_fprint(const Parser *parser, Ast_handle ast_handle,
 
   const Str kind_string = ast_kind_to_string[node->kind];
   const Token token = parser->lexer->tokens.data[node->main_token_i];
+  const Str file_path = parser->lexer->file_path;
   u32 line = 0;
   u32 column = 0;
   Str token_string = {0};
   parser_find_token_position(parser, token, &line, &column, &token_string);
 
-  ut_fwrite_indent(file, indent);
-
   pg_assert(indent < UINT16_MAX - 1); // Avoid overflow.
   switch (node->kind) {
   case AST_KIND_BOOL:
-    LOG("[%u] %.*s %.*s at %.*s:%u:%u:%u)", count, (int)kind_string.len,
-        kind_string.data, (int)token_string.len, token_string.data,
-        (int)parser->lexer->file_path.len, parser->lexer->file_path.data, line,
-        column, token.source_offset);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s at %.*s:%u:%u:%u)\n", indent, "",
+        count, (int)kind_string.len, kind_string.data, (int)token_string.len,
+        token_string.data, (int)file_path.len, file_path.data, line, column,
+        token.source_offset);
     break;
 
   case AST_KIND_LIST:
-    LOG("[%u] %.*s %.*s at %.*s:%u:%u:%u), %u children", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)parser->lexer->file_path.len,
-        parser->lexer->file_path.data, line, column, token.source_offset,
-        node->nodes.len);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s at %.*s:%u:%u:%u), %u children\n",
+        indent, "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)file_path.len,
+        file_path.data, line, column, token.source_offset, node->nodes.len);
 
     for (u64 i = 0; i < node->nodes.len; i++)
-      parser_ast_fprint(parser, node->nodes.data[i], file, indent + 2, ++count,
-                        arena);
+      parser_ast_print(parser, node->nodes.data[i], out, out_arena, indent + 2,
+                       ++count, arena);
 
     break;
   case AST_KIND_CALL: {
-    LOG("[%u] %.*s %.*s (at %.*s:%u:%u:%u), %u children", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)parser->lexer->file_path.len,
-        parser->lexer->file_path.data, line, column, token.source_offset,
-        node->nodes.len);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s (at %.*s:%u:%u:%u), %u children\n",
+        indent, "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)file_path.len,
+        file_path.data, line, column, token.source_offset, node->nodes.len);
 
     for (u64 i = 0; i < node->nodes.len; i++)
-      parser_ast_fprint(parser, node->nodes.data[i], file, indent + 2, ++count,
-                        arena);
+      parser_ast_print(parser, node->nodes.data[i], out, out_arena, indent + 2,
+                       ++count, arena);
     break;
   }
   case AST_KIND_FUNCTION_DEFINITION: {
-    LOG("[%u] %.*s %.*s (at %.*s:%u:%u:%u)", count, (int)kind_string.len,
-        kind_string.data, (int)token_string.len, token_string.data,
-        (int)parser->lexer->file_path.len, parser->lexer->file_path.data, line,
-        column, token.source_offset);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s (at %.*s:%u:%u:%u)\n", indent, "",
+        count, (int)kind_string.len, kind_string.data, (int)token_string.len,
+        token_string.data, (int)file_path.len, file_path.data, line, column,
+        token.source_offset);
 
-    parser_ast_fprint(parser, node->lhs, file, indent + 2, ++count, arena);
-    parser_ast_fprint(parser, node->return_type_ast, file, indent + 2, ++count,
-                      arena);
-    parser_ast_fprint(parser, node->rhs, file, indent + 2, ++count, arena);
+    parser_ast_print(parser, node->lhs, out, out_arena, indent + 2, ++count,
+                     arena);
+    parser_ast_print(parser, node->return_type_ast, out, out_arena, indent + 2,
+                     ++count, arena);
+    parser_ast_print(parser, node->rhs, out, out_arena, indent + 2, ++count,
+                     arena);
     break;
   }
   default:
-    LOG("[%u] %.*s %.*s (at %.*s:%u:%u:%u)", count, (int)kind_string.len,
-        kind_string.data, (int)token_string.len, token_string.data,
-        (int)parser->lexer->file_path.len, parser->lexer->file_path.data, line,
-        column, token.source_offset);
-    parser_ast_fprint(parser, node->lhs, file, indent + 2, ++count, arena);
-    parser_ast_fprint(parser, node->rhs, file, indent + 2, ++count, arena);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s (at %.*s:%u:%u:%u)\n", indent, "",
+        count, (int)kind_string.len, kind_string.data, (int)token_string.len,
+        token_string.data, (int)file_path.len, file_path.data, line, column,
+        token.source_offset);
+    parser_ast_print(parser, node->lhs, out, out_arena, indent + 2, ++count,
+                     arena);
+    parser_ast_print(parser, node->rhs, out, out_arena, indent + 2, ++count,
+                     arena);
     break;
   }
 }
 
-// --------------------------------- Typing
+// Source files are lexed and parsed in parallel, each on its own slice of the
+// arena, sized from the length of the file.
+#define SOURCE_WORKERS_MAX 32
+// Size of the first slice of a source file, relative to its size. It is kept
+// small since all the slices are reserved before parsing starts: a file
+// needing more takes it from the arena in chunks of at least the base size.
+#define SOURCE_FILE_MEMORY_FACTOR 4
+#define SOURCE_FILE_MEMORY_BASE (64 * KiB)
 
-// TODO: Caching?
-static Type_handle resolver_add_type(Resolver *resolver, Type *type,
-                                     Arena *arena) {
+typedef struct {
+  Source_file *source_files;
+  Arena *arenas;
+  u64 len;
+  u64 next; // Shared by all workers, atomically incremented.
+} Source_batch;
+
+static void *parser_source_worker_run(void *arg) {
+  Source_batch *const batch = arg;
+
+  for (;;) {
+    const u64 i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+    if (i >= batch->len)
+      break;
+
+    Source_file *const source_file = &batch->source_files[i];
+    Arena *const arena = &batch->arenas[i];
+
+    source_file->lexer = (Lexer){.file_path = source_file->file_path};
+    u8 *current = source_file->source.data;
+    lex_lex(&source_file->lexer, source_file->source, &current, arena);
+
+    source_file->parser = (Parser){
+        .buf = source_file->source,
+        .lexer = &source_file->lexer,
+    };
+    source_file->root_handle = parser_parse(&source_file->parser, arena);
+  }
+
+  return NULL;
+}
+
+static void parser_parse_source_files(Array(Source_file) source_files,
+                                      Arena scratch_arena, Arena *arena) {
+  pg_assert(arena != NULL);
+
+  if (source_files.len == 0)
+    return;
+
+  Source_batch batch = {
+      .source_files = source_files.data,
+      .arenas = arena_alloc(&scratch_arena, sizeof(Arena), _Alignof(Arena),
+                            source_files.len),
+      .len = source_files.len,
+  };
+
+  Arena_source arena_source = {
+      .arena = arena,
+      .lock = PTHREAD_MUTEX_INITIALIZER,
+      .chunk_size = SOURCE_FILE_MEMORY_BASE,
+  };
+
+  for (u64 i = 0; i < source_files.len; i++) {
+    const u64 size =
+        SOURCE_FILE_MEMORY_FACTOR * source_files.data[i].source.len +
+        SOURCE_FILE_MEMORY_BASE;
+    // Accounted for as a whole in the memory profile, if any, since the
+    // profile is not thread-safe.
+    batch.arenas[i] = arena_slice(arena, size);
+    batch.arenas[i].source = &arena_source;
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  u64 workers_count = cpus > 0 ? (u64)cpus : 1;
+  workers_count = pg_min(workers_count, SOURCE_WORKERS_MAX);
+  workers_count = pg_min(workers_count, source_files.len);
+
+  pthread_t threads[SOURCE_WORKERS_MAX] = {0};
+  bool threads_started[SOURCE_WORKERS_MAX] = {0};
+  // The calling thread is the first worker.
+  for (u64 i = 1; i < workers_count; i++)
+    threads_started[i] = pthread_create(&threads[i], NULL,
+                                        parser_source_worker_run, &batch) == 0;
+
+  parser_source_worker_run(&batch);
+
+  for (u64 i = 0; i < workers_count; i++) {
+    if (!threads_started[i])
+      continue;
+
+    const int res = pthread_join(threads[i], NULL);
+    pg_assert(res == 0);
+  }
+}
+
+// --------------------------------- Typing
+
+static Type_handle resolver_add_type_unlocked(Resolver *resolver, Type *type,
+                                              Arena *arena) {
   pg_assert(type != NULL);
 
   if (type->kind == TYPE_INSTANCE) { // Try to lower to a know type.
@@ -5131,28 +5894,69 @@ static Type_handle resolver_add_type(Resolver *resolver, Type *type,
       type->kind = TYPE_STRING;
   }
 
+  Type_intern **const intern_slot =
+      type_intern_find(&resolver->types_intern, type, *arena);
+  if (*intern_slot != NULL)
+    return (*intern_slot)->handle;
+
   const Type_handle new_type_handle = new_type(type, arena);
 
+  *intern_slot =
+      arena_alloc(arena, sizeof(Type_intern), _Alignof(Type_intern), 1);
+  (*intern_slot)->handle = new_type_handle;
+
   resolver->last_type->list_next = new_type_handle;
   resolver->last_type = type_handle_to_ptr(new_type_handle, *arena);
 
+  if (type->kind == TYPE_INSTANCE) {
+    type_index_insert(&resolver->instance_types_index, type->package_name,
+                      type->this_class_name, new_type_handle, arena);
+  } else if ((type->kind == TYPE_METHOD || type->kind == TYPE_CONSTRUCTOR) &&
+             !str_is_empty(type->v.method.name)) {
+    type_index_insert(&resolver->callables_index, (Str){0},
+                      type->v.method.name, new_type_handle, arena);
+  }
+
   return new_type_handle;
 }
 
+static Type_handle resolver_add_type(Resolver *resolver, Type *type,
+                                     Arena *arena) {
+  pg_assert(resolver != NULL);
+
+  if (resolver->types_lock == NULL)
+    return resolver_add_type_unlocked(resolver, type, arena);
+
+  int res = pthread_mutex_lock(resolver->types_lock);
+  pg_assert(res == 0);
+
+  const Type_handle type_handle =
+      resolver_add_type_unlocked(resolver, type, arena);
+
+  res = pthread_mutex_unlock(resolver->types_lock);
+  pg_assert(res == 0);
+
+  return type_handle;
+}
+
 static Str resolver_function_to_human_string(Type_handle function_i,
                                              Arena *arena, Arena handles_arena);
 
 static bool jvm_method_has_inline_only_annotation(const Class_file *class_file,
-                                                  const Jvm_method *method) {
+                                                  const Jvm_method *method,
+                                                  Arena scratch_arena) {
 
   for (u64 i = 0; i < method->attributes.len; i++) {
-    const Jvm_attribute *const attribute = &method->attributes.data[i];
-    if (attribute->kind != ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS)
+    if (method->attributes.data[i].kind !=
+        ATTRIBUTE_KIND_RUNTIME_INVISIBLE_ANNOTATIONS)
       continue;
 
-    for (u64 j = 0; j < attribute->v.runtime_invisible_annotations.len; j++) {
+    const Jvm_attribute attribute = jvm_attribute_decode(
+        class_file, &method->attributes.data[i], &scratch_arena);
+
+    for (u64 j = 0; j < attribute.v.runtime_invisible_annotations.len; j++) {
       const Jvm_annotation *const annotation =
-          &attribute->v.runtime_invisible_annotations.data[j];
+          &attribute.v.runtime_invisible_annotations.data[j];
 
       Str descriptor = jvm_constant_pool_get_as_string(
           class_file->constant_pool, annotation->type_index);
@@ -5164,6 +5968,69 @@ static bool jvm_method_has_inline_only_annotation(const Class_file *class_file,
   return false;
 }
 
+// The method type must have its name, access flags, source location and in
+// the case of InlineOnly its code and constant pool, already filled.
+static Type_handle resolver_add_method(Resolver *resolver,
+                                       Type_handle this_class_type_handle,
+                                       Str descriptor, Type *type,
+                                       Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(type != NULL);
+  pg_assert(arena != NULL);
+
+  const Type *const this_class_type =
+      type_handle_to_ptr(this_class_type_handle, *arena);
+  type->this_class_name = this_class_type->this_class_name;
+  type->package_name = this_class_type->package_name;
+
+  const u16 access_flags = type->v.method.access_flags;
+
+  jvm_parse_descriptor(resolver, descriptor, type, arena);
+  pg_assert(type->kind == TYPE_METHOD);
+
+  if (str_eq_c(type->v.method.name, CONSTRUCTOR_JVM_NAME)) {
+    type->kind = TYPE_CONSTRUCTOR;
+    type->v.method.name = type->this_class_name;
+  }
+
+  type->v.method.this_class_type_handle = this_class_type_handle;
+
+  if (type->flags & TYPE_FLAG_INLINE_ONLY) {
+    // Do as if the method was public, not private.
+    type->v.method.access_flags |= ACCESS_FLAGS_PUBLIC;
+    type->v.method.access_flags &= (u16)(~1U << ACCESS_FLAGS_PRIVATE);
+
+    pg_assert(!array_is_empty(type->v.method.code));
+  }
+
+  const Type_handle type_handle = resolver_add_type(resolver, type, arena);
+
+  if (cli_log_verbose) {
+    Arena tmp_arena = *arena;
+    Str human_type =
+        resolver_function_to_human_string(type_handle, &tmp_arena, *arena);
+    LOG("Loaded method %s: access_flags=%u type=%.*s",
+        typechecker_type_kind_string(type_handle, *arena), access_flags,
+        (int)human_type.len, human_type.data);
+  }
+
+  return type_handle;
+}
+
+// The bytecode is never in `scratch_arena`: it is either already decoded, or
+// points into the class file content.
+static Array(u8) jvm_method_code(const Class_file *class_file,
+                                 const Jvm_method *method,
+                                 Arena scratch_arena) {
+  // TODO: Clone exceptions, stack map frames, etc?
+  const Jvm_attribute *const attribute = jvm_method_find_code_attribute(method);
+  if (attribute == NULL)
+    return (Array(u8)){0};
+
+  return jvm_attribute_decode(class_file, attribute, &scratch_arena)
+      .v.code.bytecode;
+}
+
 static void resolver_load_methods_from_class_file(
     Resolver *resolver, Type_handle this_class_type_handle,
     const Class_file *class_file, Arena *arena) {
@@ -5171,9 +6038,6 @@ static void resolver_load_methods_from_class_file(
   pg_assert(class_file != NULL);
   pg_assert(arena != NULL);
 
-  const Type *const this_class_type =
-      type_handle_to_ptr(this_class_type_handle, *arena);
-
   Array(Jvm_constant_pool_entry) constant_pool_clone = {0};
   for (u64 i = 0; i < class_file->methods.len; i++) {
     const Jvm_method *const method = &class_file->methods.data[i];
@@ -5183,29 +6047,17 @@ static void resolver_load_methods_from_class_file(
                                                method->name);
 
     Type type = {
-        .this_class_name = this_class_type->this_class_name,
-        .package_name = this_class_type->package_name,
+        .v.method =
+            {
+                .name = str_clone(name, arena),
+                .access_flags = method->access_flags,
+            },
     };
-    jvm_parse_descriptor(resolver, descriptor, &type, arena);
-    pg_assert(type.kind == TYPE_METHOD);
-
-    if (str_eq_c(name, CONSTRUCTOR_JVM_NAME)) {
-      type.kind = TYPE_CONSTRUCTOR;
-      type.v.method.name = type.this_class_name;
-    } else {
-      type.v.method.name = str_clone(name, arena);
-    }
-
-    type.v.method.access_flags = method->access_flags;
-    type.v.method.this_class_type_handle = this_class_type_handle;
     jvm_get_source_location_of_function(class_file, method,
                                         &type.v.method.source_file_name,
                                         &type.v.method.source_line, arena);
 
-    if (jvm_method_has_inline_only_annotation(class_file, method)) {
-      // Do as if the method was public, not private.
-      type.v.method.access_flags |= ACCESS_FLAGS_PUBLIC;
-      type.v.method.access_flags &= (u16)(~1U << ACCESS_FLAGS_PRIVATE);
+    if (jvm_method_has_inline_only_annotation(class_file, method, *arena)) {
       type.flags |= TYPE_FLAG_INLINE_ONLY;
 
       constant_pool_clone =
@@ -5214,86 +6066,509 @@ static void resolver_load_methods_from_class_file(
               : constant_pool_clone;
       type.v.method.constant_pool = constant_pool_clone;
 
-      // Clone code.
-      // TODO: Clone exceptions, stack map frames, etc?
-      for (u64 i = 0; i < method->attributes.len; i++) {
-        const Jvm_attribute *const attribute = &method->attributes.data[i];
-        if (attribute->kind == ATTRIBUTE_KIND_CODE) {
-          type.v.method.code =
-              array_make_from_slice(u8, attribute->v.code.bytecode.data,
-                                    attribute->v.code.bytecode.len, arena);
-          break;
-        }
-      }
-      pg_assert(!array_is_empty(type.v.method.code));
+      const Array(u8) code = jvm_method_code(class_file, method, *arena);
+      type.v.method.code =
+          array_make_from_slice(u8, code.data, code.len, arena);
     }
 
-    const Type_handle type_handle = resolver_add_type(resolver, &type, arena);
+    resolver_add_method(resolver, this_class_type_handle, descriptor, &type,
+                        arena);
+  }
+}
+
+// ------------------------ Inflate
+
+// Decompression of raw DEFLATE streams (RFC 1951), as found in jar and jmod
+// files. Huffman codes are decoded with a lookup table indexed by the next
+// `INFLATE_FAST_BITS` bits of input, falling back to the canonical
+// decoding for the rare longer codes. The whole output is allocated upfront
+// since its size is known from the archive, and serves as the window.
+#define INFLATE_FAST_BITS 10
+#define INFLATE_MAX_BITS 15
+#define INFLATE_MAX_LITLEN_CODES 288
+#define INFLATE_MAX_DIST_CODES 30
 
-    if (cli_log_verbose) {
-      Arena tmp_arena = *arena;
-      Str human_type =
-          resolver_function_to_human_string(type_handle, &tmp_arena, *arena);
-      LOG("Loaded method %s [%lu]: access_flags=%u type=%.*s",
-          typechecker_type_kind_string(type_handle, *arena), i,
-          method->access_flags, (int)human_type.len, human_type.data);
+typedef struct {
+  // `symbol << 4 | code length`, or 0 when the code is longer than
+  // `INFLATE_FAST_BITS`.
+  u16 fast[1 << INFLATE_FAST_BITS];
+  u16 counts[INFLATE_MAX_BITS + 1];
+  u16 symbols[INFLATE_MAX_LITLEN_CODES];
+} Inflate_huffman;
+
+typedef struct {
+  Str in;
+  u64 in_pos;
+  u64 bits;
+  u32 bits_len;
+  bool error;
+  pg_pad(3);
+  Str out;
+  u64 out_pos;
+} Inflate;
+
+static const u16 inflate_length_base[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const u8 inflate_length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                            1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                            4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const u16 inflate_dist_base[INFLATE_MAX_DIST_CODES] = {
+    1,    2,    3,    4,    5,    7,    9,    13,    17,    25,
+    33,   49,   65,   97,   129,  193,  257,  385,   513,   769,
+    1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const u8 inflate_dist_extra[INFLATE_MAX_DIST_CODES] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static void inflate_refill(Inflate *inflate) {
+  while (inflate->bits_len <= 56 && inflate->in_pos < inflate->in.len) {
+    inflate->bits |= (u64)inflate->in.data[inflate->in_pos++]
+                     << inflate->bits_len;
+    inflate->bits_len += 8;
+  }
+}
+
+static u32 inflate_read_bits(Inflate *inflate, u32 count) {
+  pg_assert(count <= 32);
+
+  if (inflate->bits_len < count) {
+    inflate_refill(inflate);
+    if (inflate->bits_len < count) {
+      inflate->error = true;
+      return 0;
     }
   }
+
+  const u32 res = (u32)(inflate->bits & ((1ULL << count) - 1));
+  inflate->bits >>= count;
+  inflate->bits_len -= count;
+  return res;
 }
 
-static bool jvm_buf_read_jar_file(Resolver *resolver, Str content, Str path,
-                                  Arena scratch_arena, Arena *arena) {
-  pg_assert(resolver != NULL);
+// Returns false if the code lengths are over-subscribed.
+static bool inflate_huffman_build(Inflate_huffman *huffman, const u8 *lengths,
+                                  u16 lengths_len) {
+  pg_assert(huffman != NULL);
+  pg_assert(lengths_len <= INFLATE_MAX_LITLEN_CODES);
+
+  memset(huffman, 0, sizeof(*huffman));
+  for (u16 i = 0; i < lengths_len; i++)
+    huffman->counts[lengths[i]] += 1;
+  huffman->counts[0] = 0;
+
+  // Incomplete codes are allowed e.g. a single distance code.
+  i32 left = 1;
+  for (u16 len = 1; len <= INFLATE_MAX_BITS; len++) {
+    left <<= 1;
+    left -= huffman->counts[len];
+    if (left < 0)
+      return false;
+  }
+
+  u16 offsets[INFLATE_MAX_BITS + 1] = {0};
+  for (u16 len = 1; len < INFLATE_MAX_BITS; len++)
+    offsets[len + 1] = offsets[len] + huffman->counts[len];
+
+  // Codes are stored most significant bit first but read least significant
+  // bit first, so table indices use the reversed code.
+  u16 next_code[INFLATE_MAX_BITS + 1] = {0};
+  for (u16 len = 1; len < INFLATE_MAX_BITS; len++)
+    next_code[len + 1] = (u16)((next_code[len] + huffman->counts[len]) << 1);
+
+  for (u16 symbol = 0; symbol < lengths_len; symbol++) {
+    const u8 len = lengths[symbol];
+    if (len == 0)
+      continue;
+
+    huffman->symbols[offsets[len]++] = symbol;
+
+    const u16 code = next_code[len]++;
+    if (len > INFLATE_FAST_BITS)
+      continue;
+
+    u16 reversed = 0;
+    for (u8 i = 0; i < len; i++)
+      reversed |= (u16)(((code >> i) & 1) << (len - 1 - i));
+
+    for (u32 i = reversed; i < (1U << INFLATE_FAST_BITS); i += 1U << len)
+      huffman->fast[i] = (u16)(symbol << 4 | len);
+  }
+
+  return true;
+}
+
+static u16 inflate_decode(Inflate *inflate, const Inflate_huffman *huffman) {
+  if (inflate->bits_len < INFLATE_MAX_BITS)
+    inflate_refill(inflate);
+
+  const u16 entry =
+      huffman->fast[inflate->bits & ((1U << INFLATE_FAST_BITS) - 1)];
+  const u32 entry_len = entry & 0xf;
+  if (entry != 0 && entry_len <= inflate->bits_len) {
+    inflate->bits >>= entry_len;
+    inflate->bits_len -= entry_len;
+    return entry >> 4;
+  }
+
+  // Canonical decoding, one bit at a time.
+  i32 code = 0, first = 0, index = 0;
+  for (u32 len = 1; len <= INFLATE_MAX_BITS && len <= inflate->bits_len;
+       len++) {
+    code |= (i32)((inflate->bits >> (len - 1)) & 1);
+    const i32 count = huffman->counts[len];
+    if (code - count < first) {
+      inflate->bits >>= len;
+      inflate->bits_len -= len;
+      return huffman->symbols[index + (code - first)];
+    }
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+
+  inflate->error = true;
+  return 0;
+}
+
+static bool inflate_stored_block(Inflate *inflate) {
+  // Go back to byte boundaries and give back the buffered bytes.
+  inflate->bits_len -= inflate->bits_len % 8;
+  inflate->in_pos -= inflate->bits_len / 8;
+  inflate->bits = 0;
+  inflate->bits_len = 0;
+
+  if (inflate->in_pos + 4 > inflate->in.len)
+    return false;
+
+  const u8 *const header = &inflate->in.data[inflate->in_pos];
+  const u16 len = (u16)(header[0] | header[1] << 8);
+  const u16 nlen = (u16)(header[2] | header[3] << 8);
+  inflate->in_pos += 4;
+
+  if ((len ^ nlen) != 0xffff || inflate->in_pos + len > inflate->in.len ||
+      inflate->out_pos + len > inflate->out.len)
+    return false;
+
+  memcpy(&inflate->out.data[inflate->out_pos],
+         &inflate->in.data[inflate->in_pos], len);
+  inflate->in_pos += len;
+  inflate->out_pos += len;
+  return true;
+}
+
+static bool inflate_codes(Inflate *inflate, const Inflate_huffman *litlen,
+                          const Inflate_huffman *dist) {
+  for (;;) {
+    const u16 symbol = inflate_decode(inflate, litlen);
+    if (inflate->error)
+      return false;
+
+    if (symbol < 256) {
+      if (inflate->out_pos == inflate->out.len)
+        return false;
+
+      inflate->out.data[inflate->out_pos++] = (u8)symbol;
+      continue;
+    }
+
+    if (symbol == 256)
+      return true;
+
+    if (symbol - 257 >= 29)
+      return false;
+
+    const u32 len =
+        inflate_length_base[symbol - 257] +
+        inflate_read_bits(inflate, inflate_length_extra[symbol - 257]);
+
+    const u16 dist_symbol = inflate_decode(inflate, dist);
+    if (inflate->error || dist_symbol >= INFLATE_MAX_DIST_CODES)
+      return false;
+
+    const u32 distance =
+        inflate_dist_base[dist_symbol] +
+        inflate_read_bits(inflate, inflate_dist_extra[dist_symbol]);
+    if (inflate->error || distance > inflate->out_pos ||
+        inflate->out_pos + len > inflate->out.len)
+      return false;
+
+    u8 *const dst = &inflate->out.data[inflate->out_pos];
+    const u8 *const src = dst - distance;
+    if (distance >= len) {
+      memcpy(dst, src, len);
+    } else {
+      // Overlapping: the match repeats the last `distance` bytes.
+      for (u32 i = 0; i < len; i++)
+        dst[i] = src[i];
+    }
+    inflate->out_pos += len;
+  }
+}
+
+static Inflate_huffman inflate_fixed_litlen = {0};
+static Inflate_huffman inflate_fixed_dist = {0};
+static pthread_once_t inflate_fixed_once = PTHREAD_ONCE_INIT;
+
+static void inflate_fixed_init(void) {
+  u8 lengths[INFLATE_MAX_LITLEN_CODES] = {0};
+  u16 i = 0;
+  for (; i < 144; i++)
+    lengths[i] = 8;
+  for (; i < 256; i++)
+    lengths[i] = 9;
+  for (; i < 280; i++)
+    lengths[i] = 7;
+  for (; i < INFLATE_MAX_LITLEN_CODES; i++)
+    lengths[i] = 8;
+  bool ok = inflate_huffman_build(&inflate_fixed_litlen, lengths,
+                                  INFLATE_MAX_LITLEN_CODES);
+  pg_assert(ok);
+
+  for (i = 0; i < INFLATE_MAX_DIST_CODES; i++)
+    lengths[i] = 5;
+  ok = inflate_huffman_build(&inflate_fixed_dist, lengths,
+                             INFLATE_MAX_DIST_CODES);
+  pg_assert(ok);
+}
+
+static bool inflate_dynamic_tables(Inflate *inflate, Inflate_huffman *litlen,
+                                   Inflate_huffman *dist) {
+  static const u8 code_length_order[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                           11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+  const u16 litlen_len = (u16)(inflate_read_bits(inflate, 5) + 257);
+  const u16 dist_len = (u16)(inflate_read_bits(inflate, 5) + 1);
+  const u16 code_length_len = (u16)(inflate_read_bits(inflate, 4) + 4);
+  if (inflate->error || litlen_len > 286 || dist_len > INFLATE_MAX_DIST_CODES)
+    return false;
+
+  u8 lengths[INFLATE_MAX_LITLEN_CODES + INFLATE_MAX_DIST_CODES] = {0};
+  for (u16 i = 0; i < code_length_len; i++)
+    lengths[code_length_order[i]] = (u8)inflate_read_bits(inflate, 3);
+
+  Inflate_huffman code_length = {0};
+  if (inflate->error || !inflate_huffman_build(&code_length, lengths, 19))
+    return false;
+
+  memset(lengths, 0, 19);
+  for (u16 i = 0; i < litlen_len + dist_len;) {
+    const u16 symbol = inflate_decode(inflate, &code_length);
+    if (inflate->error)
+      return false;
+
+    if (symbol < 16) {
+      lengths[i++] = (u8)symbol;
+      continue;
+    }
+
+    u8 repeated = 0;
+    u32 repeat = 0;
+    if (symbol == 16) {
+      if (i == 0)
+        return false;
+      repeated = lengths[i - 1];
+      repeat = 3 + inflate_read_bits(inflate, 2);
+    } else if (symbol == 17) {
+      repeat = 3 + inflate_read_bits(inflate, 3);
+    } else {
+      repeat = 11 + inflate_read_bits(inflate, 7);
+    }
+
+    if (inflate->error || i + repeat > litlen_len + dist_len)
+      return false;
+
+    for (u32 j = 0; j < repeat; j++)
+      lengths[i++] = repeated;
+  }
+
+  // The end of block code is required.
+  if (lengths[256] == 0)
+    return false;
+
+  return inflate_huffman_build(litlen, lengths, litlen_len) &&
+         inflate_huffman_build(dist, &lengths[litlen_len], dist_len);
+}
+
+// Decompress `in` into `out`, whose length is the expected decompressed size.
+static bool inflate_raw(Str in, Str out) {
+  const int once_res = pthread_once(&inflate_fixed_once, inflate_fixed_init);
+  pg_assert(once_res == 0);
+
+  Inflate inflate = {.in = in, .out = out};
+
+  bool last = false;
+  while (!last) {
+    last = inflate_read_bits(&inflate, 1) == 1;
+    const u32 kind = inflate_read_bits(&inflate, 2);
+    if (inflate.error)
+      return false;
+
+    bool ok = false;
+    switch (kind) {
+    case 0:
+      ok = inflate_stored_block(&inflate);
+      break;
+    case 1:
+      ok = inflate_codes(&inflate, &inflate_fixed_litlen, &inflate_fixed_dist);
+      break;
+    case 2: {
+      Inflate_huffman litlen = {0}, dist = {0};
+      ok = inflate_dynamic_tables(&inflate, &litlen, &dist) &&
+           inflate_codes(&inflate, &litlen, &dist);
+      break;
+    }
+    default:
+      ok = false;
+    }
+
+    if (!ok)
+      return false;
+  }
+
+  return inflate.out_pos == inflate.out.len;
+}
+
+// Zip format constants.
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06054b50
+#define ZIP_END_OF_CENTRAL_DIRECTORY_SIZE 22
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE 0x06064b50
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE 0x07064b50
+#define ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE 20
+#define ZIP64_EXTRA_FIELD_ID 0x0001
+
+// The end of central directory record is at the end of the archive, only
+// followed by a comment of at most `UINT16_MAX` bytes. Search backwards for
+// its signature, skipping quickly to the next candidate `P` byte, and only
+// accept a record whose comment length matches the end of the archive.
+static u8 *jvm_buf_find_zip_end_of_central_directory(Str content) {
+  if (content.len < ZIP_END_OF_CENTRAL_DIRECTORY_SIZE)
+    return NULL;
+
+  const u64 last = content.len - ZIP_END_OF_CENTRAL_DIRECTORY_SIZE;
+  const u64 first =
+      last > UINT16_MAX ? last - UINT16_MAX : 0; // Longest comment.
+
+  u64 len = last - first + 1;
+  while (len > 0) {
+    u8 *const candidate = memrchr(content.data + first, 0x50, len);
+    if (candidate == NULL)
+      return NULL;
+
+    len = (u64)(candidate - (content.data + first));
+
+    u8 *current = candidate;
+    if (buf_read_le_u32(content, &current) !=
+        ZIP_END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+      continue;
+
+    u8 *comment_len_ptr = candidate + ZIP_END_OF_CENTRAL_DIRECTORY_SIZE - 2;
+    const u16 comment_len = buf_read_le_u16(content, &comment_len_ptr);
+    if (candidate + ZIP_END_OF_CENTRAL_DIRECTORY_SIZE + comment_len ==
+        content.data + content.len)
+      return candidate;
+  }
+
+  return NULL;
+}
+
+static u64 buf_read_le_u64(Str buf, u8 **current) {
+  const u64 low = buf_read_le_u32(buf, current);
+  const u64 high = buf_read_le_u32(buf, current);
+  return (high << 32) | low;
+}
+
+// Collect the `.class` entries of the archive from its central directory.
+// Zip64 archives (more than 65535 entries or bigger than 4 GiB) are supported,
+// archives split over multiple files are not.
+static Array(Jar_entry) jvm_buf_read_jar_central_directory(Str content,
+                                                           Arena *arena) {
   pg_assert(arena != NULL);
 
   u8 *current = content.data;
-  const u64 central_directory_end_size = 22;
-  pg_assert(content.len >= 4 + central_directory_end_size);
+  pg_assert(content.len >= 4 + ZIP_END_OF_CENTRAL_DIRECTORY_SIZE);
   pg_assert(buf_read_u8(content, &current) == 0x50);
   pg_assert(buf_read_u8(content, &current) == 0x4b);
   pg_assert(buf_read_u8(content, &current) == 0x03);
   pg_assert(buf_read_u8(content, &current) == 0x04);
 
-  // Assume first no trailing comment.
-  u8 *cdre = content.data + content.len - central_directory_end_size;
-  if (buf_read_le_u32(content, &cdre) != 0x06054b50) {
-    // Need to scan backwards in the presence of a trailing comment to find
-    // the magic number.
-    cdre -= sizeof(u32);
-    while (--cdre > content.data &&
-           buf_read_le_u32(content, &cdre) != 0x06054b50) {
-      cdre -= sizeof(u32);
-    }
-    pg_assert(cdre > content.data);
-  }
+  u8 *const cdre_start = jvm_buf_find_zip_end_of_central_directory(content);
+  pg_assert(cdre_start != NULL);
+  u8 *cdre = cdre_start + sizeof(u32);
 
-  // disk number
   const u16 disk_number = buf_read_le_u16(content, &cdre);
-  pg_unused(disk_number);
 
-  // disk start
-  const u16 disk_start = buf_read_le_u16(content, &cdre);
+  const u16 central_directory_disk = buf_read_le_u16(content, &cdre);
 
   // records count on this disk
-  const u16 disk_records_count = buf_read_le_u16(content, &cdre);
-  pg_unused(disk_records_count);
+  buf_read_le_u16(content, &cdre);
+
+  u64 records_count = buf_read_le_u16(content, &cdre);
+
+  u64 central_directory_size = buf_read_le_u32(content, &cdre);
+
+  u64 central_directory_offset = buf_read_le_u32(content, &cdre);
+
+  // Sign of zip64: the real values are in the zip64 end of central directory
+  // record, found with the locator right before.
+  if (records_count == UINT16_MAX || central_directory_size == UINT32_MAX ||
+      central_directory_offset == UINT32_MAX) {
+    pg_assert(cdre_start - content.data >=
+              ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE);
+    u8 *locator = cdre_start - ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE;
+    const u32 locator_signature = buf_read_le_u32(content, &locator);
+    pg_assert(locator_signature ==
+              ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE);
+
+    // disk with the zip64 end of central directory
+    buf_read_le_u32(content, &locator);
+
+    const u64 zip64_cdre_offset = buf_read_le_u64(content, &locator);
+
+    const u32 disks_count = buf_read_le_u32(content, &locator);
+    pg_assert(disks_count <= 1);
+
+    pg_assert(zip64_cdre_offset < content.len);
+    u8 *zip64_cdre = content.data + zip64_cdre_offset;
+    const u32 zip64_cdre_signature = buf_read_le_u32(content, &zip64_cdre);
+    pg_assert(zip64_cdre_signature == ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+
+    // size of the zip64 end of central directory record
+    buf_read_le_u64(content, &zip64_cdre);
+
+    // version made by
+    buf_read_le_u16(content, &zip64_cdre);
+
+    // version needed to extract
+    buf_read_le_u16(content, &zip64_cdre);
+
+    const u32 zip64_disk_number = buf_read_le_u32(content, &zip64_cdre);
+    const u32 zip64_central_directory_disk =
+        buf_read_le_u32(content, &zip64_cdre);
+    pg_assert(zip64_disk_number == 0 && zip64_central_directory_disk == 0);
+
+    // records count on this disk
+    buf_read_le_u64(content, &zip64_cdre);
 
-  const u16 records_count = buf_read_le_u16(content, &cdre);
+    records_count = buf_read_le_u64(content, &zip64_cdre);
 
-  const u32 central_directory_size = buf_read_le_u32(content, &cdre);
-  pg_unused(central_directory_size);
+    central_directory_size = buf_read_le_u64(content, &zip64_cdre);
 
-  const u32 central_directory_offset = buf_read_le_u32(content, &cdre);
+    central_directory_offset = buf_read_le_u64(content, &zip64_cdre);
+  } else {
+    // Multiple disks i.e. split archive.
+    pg_assert(disk_number == 0 && central_directory_disk == 0);
+  }
 
-  pg_assert(central_directory_offset < content.len);
+  pg_assert(central_directory_offset + central_directory_size <= content.len);
+  pg_assert(records_count <= UINT32_MAX);
 
-  // Sign of zip64.
-  pg_assert(central_directory_offset != (u32)-1);
+  Array(Jar_entry) entries =
+      array_make(Jar_entry, 0, (u32)records_count, arena);
 
   u8 *cdfh = content.data + central_directory_offset;
   for (u64 i = 0; i < records_count; i++) {
-    Arena tmp_arena = scratch_arena;
-
     pg_assert(buf_read_u8(content, &cdfh) == 0x50);
     pg_assert(buf_read_u8(content, &cdfh) == 0x4b);
     pg_assert(buf_read_u8(content, &cdfh) == 0x01);
@@ -5322,11 +6597,11 @@ static bool jvm_buf_read_jar_file(Resolver *resolver, Str content, Str path,
     buf_read_le_u32(content, &cdfh);
 
     // compressed size
-    const u32 compressed_size_according_to_directory_entry =
+    u64 compressed_size_according_to_directory_entry =
         buf_read_le_u32(content, &cdfh);
 
     // uncompressed size
-    const u32 uncompressed_size_according_to_directory_entry =
+    u64 uncompressed_size_according_to_directory_entry =
         buf_read_le_u32(content, &cdfh);
 
     const u16 file_name_length = buf_read_le_u16(content, &cdfh);
@@ -5344,21 +6619,42 @@ static bool jvm_buf_read_jar_file(Resolver *resolver, Str content, Str path,
     // external file attributes
     buf_read_le_u32(content, &cdfh);
 
-    const u32 local_file_header_offset = buf_read_le_u32(content, &cdfh);
+    u64 local_file_header_offset = buf_read_le_u32(content, &cdfh);
 
     // file name
     buf_read_n_u8(content, file_name_length, &cdfh);
 
     // extra field
-    buf_read_n_u8(content, extra_field_length, &cdfh);
+    const Str extra = buf_read_n_u8(content, extra_field_length, &cdfh);
+
+    // The zip64 extended information holds, in this order, the values which do
+    // not fit in the fields above (set to their maximum).
+    for (u8 *field = extra.data; field + 4 <= extra.data + extra.len;) {
+      const u16 id = buf_read_le_u16(extra, &field);
+      const u16 size = buf_read_le_u16(extra, &field);
+      const Str data = buf_read_n_u8(extra, size, &field);
+      if (id != ZIP64_EXTRA_FIELD_ID)
+        continue;
+
+      u8 *data_current = data.data;
+      if (uncompressed_size_according_to_directory_entry == UINT32_MAX)
+        uncompressed_size_according_to_directory_entry =
+            buf_read_le_u64(data, &data_current);
+      if (compressed_size_according_to_directory_entry == UINT32_MAX)
+        compressed_size_according_to_directory_entry =
+            buf_read_le_u64(data, &data_current);
+      if (local_file_header_offset == UINT32_MAX)
+        local_file_header_offset = buf_read_le_u64(data, &data_current);
+      break;
+    }
 
     // file comment
     buf_read_n_u8(content, file_comment_length, &cdfh);
 
     // Read file header.
     {
-      u8 *local_file_header =
-          content.data + disk_start + local_file_header_offset;
+      pg_assert(local_file_header_offset < content.len);
+      u8 *local_file_header = content.data + local_file_header_offset;
       pg_assert(buf_read_u8(content, &local_file_header) == 0x50);
       pg_assert(buf_read_u8(content, &local_file_header) == 0x4b);
       pg_assert(buf_read_u8(content, &local_file_header) == 0x03);
@@ -5400,119 +6696,854 @@ static bool jvm_buf_read_jar_file(Resolver *resolver, Str content, Str path,
 
       buf_read_n_u8(content, extra_field_length, &local_file_header);
 
-      Class_file class_file = {
-          .class_file_path = file_name,
-          .archive_file_path = path,
-      };
       // TODO: Read Manifest file?
-      if (uncompressed_size_according_to_directory_entry > 0 &&
-          compression_method == 0 && str_ends_with_c(file_name, ".class")) {
+      if (!str_ends_with_c(file_name, ".class"))
+        continue;
+
+      const u64 stored_size =
+          compression_method == 0
+              ? uncompressed_size_according_to_directory_entry
+              : compressed_size_according_to_directory_entry;
+      if (stored_size == 0)
+        continue;
+
+      // Class files cannot be that big anyway.
+      pg_assert(uncompressed_size_according_to_directory_entry <= UINT32_MAX);
+      pg_assert(local_file_header + stored_size <= content.data + content.len);
 
-        jvm_buf_read_class_file(
-            str_new(local_file_header,
-                    uncompressed_size_according_to_directory_entry),
-            &local_file_header, &class_file, &tmp_arena);
+      *array_push(&entries, arena) = (Jar_entry){
+          .file_name = file_name,
+          .data = str_new(local_file_header, stored_size),
+          .uncompressed_size =
+              (u32)uncompressed_size_according_to_directory_entry,
+          .compression_method = compression_method,
+      };
+    }
+  }
 
-        Type type = {.kind = TYPE_INSTANCE};
-        type_init_package_and_name(class_file.class_name, &type.package_name,
-                                   &type.this_class_name, arena);
+  return entries;
+}
+
+// A malformed entry is reported and left without a class name, for the caller
+// to skip it.
+static void jvm_read_jar_entry(const Jar_entry *entry, Str path,
+                               Class_file *class_file, Arena *arena) {
+  pg_assert(entry != NULL);
+  pg_assert(class_file != NULL);
+  pg_assert(arena != NULL);
 
-        const Type_handle this_class_type_handle =
-            resolver_add_type(resolver, &type, arena);
+  *class_file = (Class_file){
+      .class_file_path = entry->file_name,
+      .archive_file_path = path,
+      .lazy_attributes = true,
+      .lazy_constants = true,
+  };
 
-        if (class_file.super_class != 0) {
-          const Jvm_constant_pool_entry *const constant_super =
-              jvm_constant_pool_get(class_file.constant_pool,
-                                    class_file.super_class);
+  if (entry->compression_method == 0) {
+    if (!jvm_buf_read_class_file(entry->data, class_file, arena))
+      class_file->class_name = (Str){0};
+    return;
+  }
 
-          pg_assert(constant_super->kind == CONSTANT_POOL_KIND_CLASS_INFO);
-        }
+  pg_assert(entry->compression_method == 8);
+  Str dst = {
+      .data = arena_alloc(arena, sizeof(u8), _Alignof(u8),
+                          entry->uncompressed_size),
+      .len = entry->uncompressed_size,
+  };
 
-        resolver_load_methods_from_class_file(resolver, this_class_type_handle,
-                                              &class_file, arena);
-
-        resolver->class_file_loaded_count += 1;
-        LOG("Loaded class_file_path=%.*s [%lu] archive_file_path=%.*s "
-            "kind=uncompressed package_name=%.*s class_name=%.*s",
-            (int)class_file.class_file_path.len,
-            class_file.class_file_path.data, resolver->class_file_loaded_count,
-            (int)class_file.archive_file_path.len,
-            class_file.archive_file_path.data, (int)type.package_name.len,
-            type.package_name.data, (int)type.this_class_name.len,
-            type.this_class_name.data);
-
-      } else if (compressed_size_according_to_directory_entry > 0 &&
-                 compression_method == 8 && str_eq_c(file_name, ".class")) {
-#if WITH_ZLIB
-        Str dst = sb_build(
-            sb_new(uncompressed_size_according_to_directory_entry, &tmp_arena));
-
-        z_stream stream = {
-            .next_in = (u8 *)local_file_header,
-            .avail_in = compressed_size_according_to_directory_entry,
-            .next_out = dst.data,
-            .avail_out = dst.len,
-        };
+  if (!inflate_raw(entry->data, dst)) {
+    fprintf(stderr, "Failed to decompress the entry %.*s in %.*s\n",
+            (int)entry->file_name.len, entry->file_name.data, (int)path.len,
+            path.data);
+    exit(EINVAL);
+  }
+
+  if (!jvm_buf_read_class_file(dst, class_file, arena))
+    class_file->class_name = (Str){0};
+}
+
+// Inflating and parsing class files is independent for each entry so it is
+// spread over multiple threads, each with their own arena. Entries are claimed
+// one at a time since their sizes, and thus their costs, vary a lot. The
+// resulting class files are then handed over on the calling thread, in the
+// archive order.
+#define JAR_WORKERS_MAX 32
+#define JAR_WORKER_BATCH_SIZE 64
+// Minimum size of the arena of a worker, bigger when the largest entry needs
+// it.
+#define JAR_WORKER_ARENA_SIZE (32 * MiB)
+// Upper bound of the memory used to inflate and parse an entry, relative to
+// its uncompressed size. A batch is small enough for a single worker to
+// process it entirely, whatever the distribution of the work ends up being.
+#define JAR_WORKER_ENTRY_MEMORY_FACTOR 8
+
+typedef struct {
+  const Jar_archive *archive;
+  const u32 *entry_indices;
+  Class_file *class_files;
+  u64 len;
+  u64 next; // Shared by all workers, atomically incremented.
+} Jar_batch;
 
-        // `inflateInit2` is required instead of `inflateInit` because this is a
-        // raw compressed stream and not a zlib compressed stream which contains
-        // a header.
-        int res = inflateInit2(&stream, -8);
-        pg_assert(res == Z_OK);
+typedef struct {
+  Jar_batch *batch;
+  Arena arena;
+} Jar_worker;
 
-        res = inflate(&stream, Z_SYNC_FLUSH);
-        pg_assert(res == Z_STREAM_END);
+static void *jvm_jar_worker_run(void *arg) {
+  Jar_worker *const worker = arg;
+  Jar_batch *const batch = worker->batch;
 
-        u8 *dst_current = dst.data;
-        jvm_buf_read_class_file(dst, &dst_current, &class_file, &tmp_arena);
+  for (;;) {
+    const u64 i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+    if (i >= batch->len)
+      break;
 
-        Type type = {.kind = TYPE_INSTANCE};
-        type_init_package_and_name(class_file.class_name, &type.package_name,
-                                   &type.this_class_name, arena);
+    jvm_read_jar_entry(&batch->archive->entries.data[batch->entry_indices[i]],
+                       batch->archive->path, &batch->class_files[i],
+                       &worker->arena);
+  }
 
-        const u32 this_class_type_handle =
-            resolver_add_type(resolver, resolver, &type, arena);
+  return NULL;
+}
 
-        if (class_file.super_class != 0) {
-          const Jvm_constant *const constant_super = jvm_constant_pool_get(
-              &class_file.constant_pool, class_file.super_class);
+static u64 jvm_jar_workers_count(u64 entries_count) {
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  u64 res = cpus > 0 ? (u64)cpus : 1;
+  if (res > JAR_WORKERS_MAX)
+    res = JAR_WORKERS_MAX;
 
-          pg_assert(constant_super->kind == CONSTANT_POOL_KIND_CLASS_INFO);
-          Str super_class_name = jvm_constant_pool_get_as_string(
-              &class_file.constant_pool, constant_super->v.string_utf8_i);
+  // Not worth spawning threads for a handful of entries.
+  const u64 useful = (entries_count + JAR_WORKER_BATCH_SIZE - 1) /
+                     JAR_WORKER_BATCH_SIZE;
+  if (res > useful)
+    res = useful;
 
-          if (!str_eq_c(super_class_name, "java/lang/Object")) {
-            type.super_class_name = super_class_name;
-          }
-        }
+  return res > 0 ? res : 1;
+}
+
+typedef void (*Jar_class_file_handler)(void *ctx, const Class_file *class_file,
+                                       const Jar_entry *entry);
+
+static void jvm_read_jar_entries(const Jar_archive *archive,
+                                 Array(u32) entry_indices, Arena scratch_arena,
+                                 Jar_class_file_handler on_class_file,
+                                 void *ctx) {
+  pg_assert(archive != NULL);
+  pg_assert(archive->cache.header == NULL);
+  pg_assert(on_class_file != NULL);
+
+  if (entry_indices.len == 0)
+    return;
+
+  const u64 workers_count = jvm_jar_workers_count(entry_indices.len);
+  const u64 batch_cap = workers_count * JAR_WORKER_BATCH_SIZE;
+
+  // Any single entry fits in the arena of a worker.
+  u64 largest_entry_bytes = 0;
+  for (u64 i = 0; i < entry_indices.len; i++)
+    largest_entry_bytes =
+        pg_max(largest_entry_bytes,
+               archive->entries.data[entry_indices.data[i]].uncompressed_size);
+
+  const u64 batch_bytes_max =
+      pg_max(JAR_WORKER_ARENA_SIZE / JAR_WORKER_ENTRY_MEMORY_FACTOR,
+             largest_entry_bytes);
+  const u64 worker_arena_size =
+      batch_bytes_max * JAR_WORKER_ENTRY_MEMORY_FACTOR;
+
+  // Only the pages actually used are committed.
+  const Arena workers_arena =
+      arena_new(workers_count * worker_arena_size, NULL);
+  Jar_worker workers[JAR_WORKERS_MAX] = {0};
+  pthread_t threads[JAR_WORKERS_MAX] = {0};
+  bool threads_started[JAR_WORKERS_MAX] = {0};
+
+  Class_file *const class_files = arena_alloc(
+      &scratch_arena, sizeof(Class_file), _Alignof(Class_file), batch_cap);
+
+  for (u64 batch_start = 0; batch_start < entry_indices.len;) {
+    // Always at least one entry, which fits by construction.
+    u64 batch_len = 1;
+    u64 batch_bytes = archive->entries.data[entry_indices.data[batch_start]]
+                          .uncompressed_size;
+    while (batch_len < batch_cap &&
+           batch_start + batch_len < entry_indices.len) {
+      const u64 entry_bytes =
+          archive->entries.data[entry_indices.data[batch_start + batch_len]]
+              .uncompressed_size;
+      if (batch_bytes + entry_bytes > batch_bytes_max)
+        break;
+
+      batch_bytes += entry_bytes;
+      batch_len += 1;
+    }
+
+    Jar_batch batch = {
+        .archive = archive,
+        .entry_indices = &entry_indices.data[batch_start],
+        .class_files = class_files,
+        .len = batch_len,
+    };
+
+    for (u64 i = 0; i < workers_count; i++) {
+      Jar_worker *const worker = &workers[i];
+      *worker = (Jar_worker){
+          .batch = &batch,
+          .arena =
+              {
+                  .start = workers_arena.start + i * worker_arena_size,
+                  .end = workers_arena.start + (i + 1) * worker_arena_size,
+              },
+      };
+
+      // The calling thread is the first worker. If a thread cannot be
+      // started, the other workers simply claim its share of the entries.
+      threads_started[i] =
+          i > 0 &&
+          pthread_create(&threads[i], NULL, jvm_jar_worker_run, worker) == 0;
+    }
+
+    jvm_jar_worker_run(&workers[0]);
+
+    for (u64 i = 0; i < workers_count; i++) {
+      if (!threads_started[i])
+        continue;
+
+      const int res = pthread_join(threads[i], NULL);
+      pg_assert(res == 0);
+    }
+
+    for (u64 i = 0; i < batch_len; i++) {
+      if (str_is_empty(class_files[i].class_name)) // Malformed.
+        continue;
+
+      on_class_file(
+          ctx, &class_files[i],
+          &archive->entries.data[entry_indices.data[batch_start + i]]);
+    }
+
+    batch_start += batch_len;
+  }
+
+  munmap(workers_arena.start, (u64)(workers_arena.end - workers_arena.start));
+}
+
+// `kind` describes where the class file comes from, for logging.
+static Type_handle resolver_load_class_file(Resolver *resolver,
+                                            const Class_file *class_file,
+                                            char *kind, Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(class_file != NULL);
+  pg_assert(kind != NULL);
+  pg_assert(arena != NULL);
+
+  Type type = {.kind = TYPE_INSTANCE};
+  type_init_package_and_name(class_file->class_name, &type.package_name,
+                             &type.this_class_name, arena);
+
+  const Type_handle this_class_type_handle =
+      resolver_add_type(resolver, &type, arena);
+
+  if (class_file->super_class != 0) {
+    const Jvm_constant_pool_entry *const constant_super =
+        jvm_constant_pool_get(class_file->constant_pool,
+                              class_file->super_class);
+
+    pg_assert(constant_super->kind == CONSTANT_POOL_KIND_CLASS_INFO);
+  }
+
+  resolver_load_methods_from_class_file(resolver, this_class_type_handle,
+                                        class_file, arena);
+
+  resolver->class_file_loaded_count += 1;
+  LOG("Loaded class_file_path=%.*s [%lu] archive_file_path=%.*s "
+      "kind=%s package_name=%.*s class_name=%.*s",
+      (int)class_file->class_file_path.len, class_file->class_file_path.data,
+      resolver->class_file_loaded_count,
+      (int)class_file->archive_file_path.len,
+      class_file->archive_file_path.data, kind, (int)type.package_name.len,
+      type.package_name.data, (int)type.this_class_name.len,
+      type.this_class_name.data);
+
+  return this_class_type_handle;
+}
+
+typedef struct {
+  Resolver *resolver;
+  Arena *arena;
+} Resolver_load_ctx;
+
+static void resolver_on_class_file(void *ctx, const Class_file *class_file,
+                                   const Jar_entry *entry) {
+  Resolver_load_ctx *const load_ctx = ctx;
+  resolver_load_class_file(
+      load_ctx->resolver, class_file,
+      entry->compression_method == 0 ? "uncompressed" : "compressed",
+      load_ctx->arena);
+}
+
+// ------------------------ Class path cache
+
+static bool cli_no_cache = false;
+
+// E.g. `$XDG_CACHE_HOME/micro-kotlin/<hash of the archive path>.cache`. Empty
+// if there is no suitable cache directory.
+static Str jvm_class_path_cache_path(Str archive_real_path, Arena *arena) {
+  pg_assert(arena != NULL);
+
+  Str_builder dir = sb_new(256, arena);
+  const char *const xdg_cache_home = getenv("XDG_CACHE_HOME");
+  const char *const home = getenv("HOME");
+  if (xdg_cache_home != NULL && *xdg_cache_home != 0) {
+    dir = sb_append_c(dir, (char *)xdg_cache_home, arena);
+  } else if (home != NULL && *home != 0) {
+    dir = sb_append_c(dir, (char *)home, arena);
+    dir = sb_append_c(dir, "/.cache", arena);
+    mkdir((char *)dir.data, 0755);
+  } else {
+    return (Str){0};
+  }
+
+  dir = sb_append_c(dir, "/micro-kotlin", arena);
+  if (mkdir((char *)dir.data, 0755) == -1 && errno != EEXIST)
+    return (Str){0};
+
+  char file_name[64] = {0};
+  snprintf(file_name, sizeof(file_name), "/%016lx.cache",
+           ut_fnv1a(UT_FNV1A_OFFSET_BASIS, archive_real_path.data,
+                    archive_real_path.len));
+
+  return sb_build(sb_append_c(dir, file_name, arena));
+}
+
+static Str class_path_cache_str(const Class_path_cache *cache,
+                                Class_path_cache_str s) {
+  pg_assert(cache != NULL);
+  pg_assert((u64)s.offset + s.len <= cache->header->strings_len);
+
+  return (Str){.data = cache->strings + s.offset, .len = s.len};
+}
+
+static i64 class_path_cache_find_class(const Class_path_cache *cache,
+                                       Str class_name) {
+  pg_assert(cache != NULL);
+  pg_assert(cache->header != NULL);
+
+  const u64 mask = cache->header->index_cap - 1;
+  for (u64 i = jvm_class_name_hash(class_name) & mask;; i = (i + 1) & mask) {
+    const u32 slot = cache->index[i];
+    if (slot == 0)
+      return -1;
+
+    const Class_path_cache_class *const class = &cache->classes[slot - 1];
+    if (jvm_class_names_equal(
+            class_name, class_path_cache_str(cache, class->class_name)))
+      return slot - 1;
+  }
+}
+
+typedef struct {
+  Array(Class_path_cache_class) classes;
+  Array(Class_path_cache_method) methods;
+  FILE *strings;
+  Arena arena;
+  Arena scratch_arena;
+} Class_path_cache_writer;
+
+static Class_path_cache_str jvm_class_path_cache_write_str(FILE *strings,
+                                                           Str s) {
+  const long offset = ftell(strings);
+  pg_assert(offset >= 0 && offset <= UINT32_MAX);
+  pg_assert(s.len <= UINT32_MAX);
+
+  if (s.len > 0)
+    fwrite(s.data, sizeof(u8), s.len, strings);
+
+  return (Class_path_cache_str){.offset = (u32)offset, .len = (u32)s.len};
+}
+
+static void jvm_class_path_cache_add_class(void *ctx,
+                                           const Class_file *class_file,
+                                           const Jar_entry *entry) {
+  Class_path_cache_writer *const writer = ctx;
+  pg_assert(writer != NULL);
+  pg_assert(class_file != NULL);
+  pg_assert(entry != NULL);
+
+  FILE *const strings = writer->strings;
+  // Reset for each class.
+  Arena scratch_arena = writer->scratch_arena;
+
+  Class_path_cache_class *const class =
+      array_push(&writer->classes, &writer->arena);
+  class->class_name =
+      jvm_class_path_cache_write_str(strings, class_file->class_name);
+  class->file_name = jvm_class_path_cache_write_str(strings, entry->file_name);
+  class->methods_start = writer->methods.len;
+  pg_assert(class_file->methods.len <= UINT16_MAX);
+  class->methods_len = class_file->methods.len;
+
+  bool has_inline_only = false;
+  for (u64 i = 0; i < class_file->methods.len; i++) {
+    const Jvm_method *const method = &class_file->methods.data[i];
+
+    const bool inline_only =
+        jvm_method_has_inline_only_annotation(class_file, method,
+                                              scratch_arena);
+    has_inline_only |= inline_only;
+
+    Str source_file_name = {0};
+    u16 source_line = 0;
+    jvm_get_source_location_of_function(class_file, method, &source_file_name,
+                                        &source_line, &scratch_arena);
+
+    *array_push(&writer->methods, &writer->arena) = (Class_path_cache_method){
+        .name = jvm_class_path_cache_write_str(
+            strings, jvm_constant_pool_get_as_string(class_file->constant_pool,
+                                                     method->name)),
+        .descriptor = jvm_class_path_cache_write_str(
+            strings, jvm_constant_pool_get_as_string(class_file->constant_pool,
+                                                     method->descriptor)),
+        .source_file_name =
+            jvm_class_path_cache_write_str(strings, source_file_name),
+        .access_flags = method->access_flags,
+        .flags = inline_only ? TYPE_FLAG_INLINE_ONLY : 0,
+        .source_line = source_line,
+    };
+
+    if (inline_only) {
+      const Array(u8) code = jvm_method_code(class_file, method, scratch_arena);
+      array_last(writer->methods)->code = jvm_class_path_cache_write_str(
+          strings, (Str){.data = code.data, .len = code.len});
+    }
+  }
+
+  if (has_inline_only) {
+    Str_builder constant_pool = sb_new(4 * KiB, &scratch_arena);
+    jvm_write_constant_pool(class_file, &constant_pool, &scratch_arena);
+    class->constant_pool =
+        jvm_class_path_cache_write_str(strings, sb_build(constant_pool));
+  }
+}
+
+static bool jvm_write_class_path_cache(const Jar_archive *archive,
+                                       Str archive_real_path,
+                                       const struct stat *archive_stat,
+                                       Str cache_path, Arena scratch_arena) {
+  pg_assert(archive != NULL);
+  pg_assert(archive_stat != NULL);
+
+  // Written to a temporary file first so that concurrent compilations never
+  // observe a partial cache.
+  Str_builder tmp_path = sb_new(cache_path.len + 32, &scratch_arena);
+  tmp_path = sb_append(tmp_path, cache_path, &scratch_arena);
+  char tmp_suffix[32] = {0};
+  snprintf(tmp_suffix, sizeof(tmp_suffix), ".%d.tmp", getpid());
+  tmp_path = sb_append_c(tmp_path, tmp_suffix, &scratch_arena);
+
+  FILE *const file = fopen((char *)tmp_path.data, "w");
+  if (file == NULL)
+    return false;
+
+  Array(u32) entry_indices =
+      array_make(u32, 0, archive->entries.len, &scratch_arena);
+  for (u64 i = 0; i < archive->entries.len; i++) {
+    if (!str_starts_with(archive->entries.data[i].file_name,
+                         str_from_c("META-INF/")))
+      *array_push(&entry_indices, &scratch_arena) = (u32)i;
+  }
+
+  char *strings_data = NULL;
+  u64 strings_len = 0;
+  Class_path_cache_writer writer = {
+      .strings = open_memstream(&strings_data, &strings_len),
+      .arena = arena_new(512 * MiB, NULL),
+      .scratch_arena = arena_new(64 * MiB, NULL),
+  };
+  pg_assert(writer.strings != NULL);
+
+  writer.classes =
+      array_make(Class_path_cache_class, 0, entry_indices.len, &writer.arena);
+  // Store the archive path first so that its offset is 0.
+  const Class_path_cache_str archive_path =
+      jvm_class_path_cache_write_str(writer.strings, archive_real_path);
+
+  jvm_read_jar_entries(archive, entry_indices, scratch_arena,
+                       jvm_class_path_cache_add_class, &writer);
+  // Flushes the strings to `strings_data`.
+  const int strings_err = fclose(writer.strings);
+  if (strings_err != 0) {
+    free(strings_data);
+    munmap(writer.arena.start, (u64)(writer.arena.end - writer.arena.start));
+    munmap(writer.scratch_arena.start,
+           (u64)(writer.scratch_arena.end - writer.scratch_arena.start));
+    fclose(file);
+    unlink((char *)tmp_path.data);
+    return false;
+  }
+
+  u32 index_cap = 16;
+  while (index_cap < 2 * writer.classes.len)
+    index_cap *= 2;
+
+  u32 *const index = arena_alloc(&scratch_arena, sizeof(u32), _Alignof(u32),
+                                 index_cap);
+  for (u32 i = 0; i < writer.classes.len; i++) {
+    const Str class_name = {
+        .data = (u8 *)strings_data + writer.classes.data[i].class_name.offset,
+        .len = writer.classes.data[i].class_name.len,
+    };
+
+    for (u64 j = jvm_class_name_hash(class_name) & (index_cap - 1);;
+         j = (j + 1) & (index_cap - 1)) {
+      if (index[j] == 0) {
+        index[j] = i + 1;
+        break;
+      }
+
+      const Class_path_cache_str other =
+          writer.classes.data[index[j] - 1].class_name;
+      if (jvm_class_names_equal(
+              class_name, (Str){.data = (u8 *)strings_data + other.offset,
+                                .len = other.len}))
+        break; // Duplicate entry: the first one wins.
+    }
+  }
+
+  pg_assert(strings_len <= UINT32_MAX);
+  const Class_path_cache_header header = {
+      .magic = CLASS_PATH_CACHE_MAGIC,
+      .version = CLASS_PATH_CACHE_VERSION,
+      .archive_size = (u64)archive_stat->st_size,
+      .archive_mtime_sec = (u64)archive_stat->st_mtim.tv_sec,
+      .archive_mtime_nsec = (u64)archive_stat->st_mtim.tv_nsec,
+      .archive_path = archive_path,
+      .classes_len = writer.classes.len,
+      .methods_len = writer.methods.len,
+      .index_cap = index_cap,
+      .strings_len = (u32)strings_len,
+  };
+  fwrite(&header, sizeof(header), 1, file);
+  // The arrays are NULL when empty.
+  if (writer.classes.len > 0)
+    fwrite(writer.classes.data, sizeof(Class_path_cache_class),
+           writer.classes.len, file);
+  if (writer.methods.len > 0)
+    fwrite(writer.methods.data, sizeof(Class_path_cache_method),
+           writer.methods.len, file);
+  fwrite(index, sizeof(u32), index_cap, file);
+  fwrite(strings_data, sizeof(u8), strings_len, file);
+
+  free(strings_data);
+  munmap(writer.arena.start, (u64)(writer.arena.end - writer.arena.start));
+  munmap(writer.scratch_arena.start,
+         (u64)(writer.scratch_arena.end - writer.scratch_arena.start));
+
+  const bool success = ferror(file) == 0;
+  if (fclose(file) != 0 || !success ||
+      rename((char *)tmp_path.data, (char *)cache_path.data) == -1) {
+    unlink((char *)tmp_path.data);
+    return false;
+  }
+
+  return true;
+}
+
+static bool class_path_cache_str_valid(const Class_path_cache *cache,
+                                       Class_path_cache_str s) {
+  return (u64)s.offset + s.len <= cache->header->strings_len;
+}
+
+// The constant pool of a class is decoded when loading the class, where
+// malformed content would be fatal, so it is decoded once here beforehand.
+static bool class_path_cache_constant_pool_valid(Str buf, Arena scratch_arena) {
+  if (buf.len == 0)
+    return true;
+
+  Jvm_read_error error = {0};
+  Jvm_reader reader = {.buf = buf, .current = buf.data, .on_error = &error};
+  if (setjmp(error.jmp) != 0)
+    return false;
+
+  jvm_reader_need(&reader, sizeof(u16));
+  const u16 constant_pool_count = jvm_reader_be_u16(&reader);
+  jvm_reader_expect(&reader, constant_pool_count > 0,
+                    "invalid constant pool count");
+
+  Class_file class_file = {
+      .constant_pool = array_make(Jvm_constant_pool_entry, 0,
+                                  constant_pool_count - 1, &scratch_arena),
+  };
+  jvm_buf_read_constants(&reader, &class_file, constant_pool_count - 1,
+                         &scratch_arena);
+
+  return jvm_reader_remaining(&reader) == 0;
+}
+
+// The cache is used in place, so every offset in it is checked once here and
+// then trusted. A cache failing these checks is ignored like a stale one.
+static bool class_path_cache_valid(const Class_path_cache *cache,
+                                   Arena scratch_arena) {
+  const Class_path_cache_header *const header = cache->header;
+
+  if (!class_path_cache_str_valid(cache, header->archive_path))
+    return false;
+
+  for (u64 i = 0; i < header->methods_len; i++) {
+    const Class_path_cache_method *const method = &cache->methods[i];
+    if (!class_path_cache_str_valid(cache, method->name) ||
+        !class_path_cache_str_valid(cache, method->descriptor) ||
+        !class_path_cache_str_valid(cache, method->source_file_name) ||
+        !class_path_cache_str_valid(cache, method->code))
+      return false;
+  }
+
+  for (u64 i = 0; i < header->classes_len; i++) {
+    const Class_path_cache_class *const class = &cache->classes[i];
+    if (!class_path_cache_str_valid(cache, class->class_name) ||
+        !class_path_cache_str_valid(cache, class->file_name) ||
+        !class_path_cache_str_valid(cache, class->constant_pool) ||
+        (u64)class->methods_start + class->methods_len > header->methods_len ||
+        !class_path_cache_constant_pool_valid(
+            class_path_cache_str(cache, class->constant_pool), scratch_arena))
+      return false;
+  }
+
+  // Lookups stop at the first empty slot, so there must be one.
+  bool has_empty_slot = false;
+  for (u64 i = 0; i < header->index_cap; i++) {
+    const u32 slot = cache->index[i];
+    if (slot > header->classes_len)
+      return false;
+    has_empty_slot |= slot == 0;
+  }
+
+  return has_empty_slot;
+}
+
+// On success, the cache stays mapped in memory.
+static bool jvm_open_class_path_cache(Class_path_cache *cache,
+                                      Str archive_real_path,
+                                      const struct stat *archive_stat,
+                                      Str cache_path, Arena scratch_arena) {
+  pg_assert(cache != NULL);
+  pg_assert(archive_stat != NULL);
+
+  Read_result read_res = ut_file_mmap(str_to_c(cache_path, &scratch_arena));
+  if (read_res.error || read_res.content.len < sizeof(Class_path_cache_header))
+    return false;
+
+  const Str content = read_res.content;
+  const Class_path_cache_header *const header = (void *)content.data;
+
+  const u64 expected_len =
+      sizeof(Class_path_cache_header) +
+      (u64)header->classes_len * sizeof(Class_path_cache_class) +
+      (u64)header->methods_len * sizeof(Class_path_cache_method) +
+      (u64)header->index_cap * sizeof(u32) + header->strings_len;
+
+  // Also rejects caches written on a machine of a different endianness.
+  if (header->magic != CLASS_PATH_CACHE_MAGIC ||
+      header->version != CLASS_PATH_CACHE_VERSION ||
+      header->archive_size != (u64)archive_stat->st_size ||
+      header->archive_mtime_sec != (u64)archive_stat->st_mtim.tv_sec ||
+      header->archive_mtime_nsec != (u64)archive_stat->st_mtim.tv_nsec ||
+      content.len != expected_len || header->index_cap == 0 ||
+      (header->index_cap & (header->index_cap - 1)) != 0) {
+    munmap(content.data, content.len);
+    return false;
+  }
+
+  u8 *current = content.data + sizeof(Class_path_cache_header);
+  *cache = (Class_path_cache){.header = header};
+  cache->classes = (void *)current;
+  current += header->classes_len * sizeof(Class_path_cache_class);
+  cache->methods = (void *)current;
+  current += header->methods_len * sizeof(Class_path_cache_method);
+  cache->index = (void *)current;
+  current += header->index_cap * sizeof(u32);
+  cache->strings = current;
+
+  // The hash of the path is used as the file name, so collisions are
+  // possible.
+  if (!class_path_cache_valid(cache, scratch_arena) ||
+      !str_eq(class_path_cache_str(cache, header->archive_path),
+              archive_real_path)) {
+    munmap(content.data, content.len);
+    *cache = (Class_path_cache){0};
+    return false;
+  }
+
+  return true;
+}
+
+static void resolver_load_class_path_cache_class(Resolver *resolver,
+                                                 const Jar_archive *archive,
+                                                 u32 class_i, Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(archive != NULL);
+  pg_assert(arena != NULL);
+
+  const Class_path_cache *const cache = &archive->cache;
+  pg_assert(class_i < cache->header->classes_len);
+  const Class_path_cache_class *const class = &cache->classes[class_i];
+
+  Type type = {.kind = TYPE_INSTANCE};
+  type_init_package_and_name(class_path_cache_str(cache, class->class_name),
+                             &type.package_name, &type.this_class_name, arena);
+  const Type_handle this_class_type_handle =
+      resolver_add_type(resolver, &type, arena);
+
+  // Shared by all the InlineOnly methods of the class.
+  Class_file class_file = {0};
+  if (class->constant_pool.len > 0) {
+    // Validated when opening the cache.
+    Jvm_reader reader = {
+        .buf = class_path_cache_str(cache, class->constant_pool),
+    };
+    reader.current = reader.buf.data;
+    jvm_reader_need(&reader, sizeof(u16));
+    const u16 constant_pool_count = jvm_reader_be_u16(&reader);
+    pg_assert(constant_pool_count > 0);
+
+    class_file.constant_pool = array_make(Jvm_constant_pool_entry, 0,
+                                          constant_pool_count - 1, arena);
+    jvm_buf_read_constants(&reader, &class_file, constant_pool_count - 1,
+                           arena);
+  }
+
+  pg_assert((u64)class->methods_start + class->methods_len <=
+            cache->header->methods_len);
+  for (u64 i = 0; i < class->methods_len; i++) {
+    const Class_path_cache_method *const method =
+        &cache->methods[class->methods_start + i];
+    const Str code = class_path_cache_str(cache, method->code);
+
+    // Strings and code point to the cache.
+    Type method_type = {
+        .flags = method->flags,
+        .v.method =
+            {
+                .access_flags = method->access_flags,
+                .name = class_path_cache_str(cache, method->name),
+                .source_file_name =
+                    class_path_cache_str(cache, method->source_file_name),
+                .source_line = method->source_line,
+                .code = {.data = code.data,
+                         .len = method->code.len,
+                         .cap = method->code.len},
+            },
+    };
+    if (method->flags & TYPE_FLAG_INLINE_ONLY)
+      method_type.v.method.constant_pool = class_file.constant_pool;
+
+    resolver_add_method(resolver, this_class_type_handle,
+                        class_path_cache_str(cache, method->descriptor),
+                        &method_type, arena);
+  }
+
+  const Str file_name = class_path_cache_str(cache, class->file_name);
+  resolver->class_file_loaded_count += 1;
+  LOG("Loaded class_file_path=%.*s [%lu] archive_file_path=%.*s "
+      "kind=cached package_name=%.*s class_name=%.*s",
+      (int)file_name.len, file_name.data, resolver->class_file_loaded_count,
+      (int)archive->path.len, archive->path.data, (int)type.package_name.len,
+      type.package_name.data, (int)type.this_class_name.len,
+      type.this_class_name.data);
+}
+
+// The class name of an entry e.g. `classes/java/lang/Object.class` (jmod) or
+// `java/lang/Object.class` (jar) -> `java/lang/Object`.
+static Str jvm_jar_entry_class_name(Str file_name) {
+  const Str jmod_prefix = str_from_c("classes/");
+  if (str_starts_with(file_name, jmod_prefix))
+    file_name = str_advance(file_name, jmod_prefix.len);
+
+  const Str extension = str_from_c(".class");
+  pg_assert(str_ends_with(file_name, extension));
+  file_name.len -= extension.len;
+
+  return file_name;
+}
+
+// Classes are entries of the archive, or of the class path cache when used.
+static u32 jar_archive_classes_len(const Jar_archive *archive) {
+  return archive->cache.header != NULL ? archive->cache.header->classes_len
+                                       : archive->entries.len;
+}
+
+// Empty for entries which are not classes of the archive.
+static Str jar_archive_class_name(const Jar_archive *archive, u32 class_i) {
+  if (archive->cache.header != NULL)
+    return class_path_cache_str(&archive->cache,
+                                archive->cache.classes[class_i].class_name);
+
+  const Str file_name = archive->entries.data[class_i].file_name;
+  // Multi-release jars store alternative versions of classes there.
+  if (str_starts_with(file_name, str_from_c("META-INF/")))
+    return (Str){0};
+
+  return jvm_jar_entry_class_name(file_name);
+}
+
+static i64 jar_archive_find_class(Jar_archive *archive, Str class_name) {
+  if (archive->cache.header != NULL)
+    return class_path_cache_find_class(&archive->cache, class_name);
+
+  Jar_class_index *const index =
+      *jar_class_index_find(&archive->class_index, class_name);
+  return index != NULL ? (i64)index->entry_i : -1;
+}
+
+// Load the given classes of the archive, in this order, skipping those already
+// loaded.
+static void resolver_load_jar_entries(Resolver *resolver, Jar_archive *archive,
+                                      Array(u32) class_indices,
+                                      Arena scratch_arena, Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(archive != NULL);
+  pg_assert(arena != NULL);
+
+  {
+    u32 len = 0;
+    for (u64 i = 0; i < class_indices.len; i++) {
+      const u32 class_i = class_indices.data[i];
+      bool *const loaded = archive->cache.header != NULL
+                               ? &archive->cache_classes_loaded[class_i]
+                               : &archive->entries.data[class_i].loaded;
+      if (*loaded)
+        continue;
 
-        resolver_load_methods_from_class_file(resolver, this_class_type_handle,
-                                              &class_file, arena);
-
-        LOG("Loaded class_file_path=%.*s  archive_file_path=%.*s "
-            "kind=compressed package_name=%.*s class_name=%.*s",
-            (int)class_file.class_file_path.len,
-            class_file.class_file_path.data,
-            (int)class_file.archive_file_path.len,
-            class_file.archive_file_path.data, (int)type.package_name.len,
-            type.package_name.data, (int)type.this_class_name.len,
-            type.this_class_name.data);
-
-        inflateEnd(&stream);
-#else
-        pg_assert(0 && "WITH_ZLIB not set, no zlib decompression support");
-#endif
-      }
+      *loaded = true;
+      class_indices.data[len++] = class_i;
     }
+    class_indices.len = len;
   }
-  return false;
+
+  if (archive->cache.header != NULL) {
+    for (u64 i = 0; i < class_indices.len; i++)
+      resolver_load_class_path_cache_class(resolver, archive,
+                                           class_indices.data[i], arena);
+    return;
+  }
+
+  Resolver_load_ctx ctx = {.resolver = resolver, .arena = arena};
+  jvm_read_jar_entries(archive, class_indices, scratch_arena,
+                       resolver_on_class_file, &ctx);
 }
-static bool jvm_read_jmod_file(Resolver *resolver, Str path,
-                               Arena scratch_arena, Arena *arena) {
+
+// Map the archive, or its class path cache, and index its classes by name,
+// without loading them.
+static bool resolver_open_archive(Resolver *resolver, Str path,
+                                  Arena scratch_arena, Arena *arena) {
   pg_assert(resolver != NULL);
   pg_assert(arena != NULL);
 
   char *path_cstr = str_to_c(path, &scratch_arena);
+  // Unless the class path cache is used, never unmapped since classes are
+  // loaded lazily from it.
   Read_result read_res = ut_file_mmap(path_cstr);
   if (read_res.error) {
     fprintf(stderr, "Failed to read the file %.*s: %s\n", (int)path.len,
@@ -5521,42 +7552,138 @@ static bool jvm_read_jmod_file(Resolver *resolver, Str path,
   }
 
   Str content = read_res.content;
-  // Check magic number.
-  {
+  if (str_ends_with_c(path, ".jmod")) {
+    // Check magic number.
     u8 *current = content.data;
     pg_assert(buf_read_u8(content, &current) == 'J');
     pg_assert(buf_read_u8(content, &current) == 'M');
     pg_assert(buf_read_u8(content, &current) == 1);
     pg_assert(buf_read_u8(content, &current) == 0);
+
+    content = str_advance(content, 4);
+  }
+
+  Jar_archive archive = {.path = path};
+
+  struct stat archive_stat = {0};
+  char real_path_cstr[PATH_MAX] = {0};
+  Str cache_path = {0};
+  Str real_path = {0};
+  if (!cli_no_cache && stat(path_cstr, &archive_stat) == 0 &&
+      realpath(path_cstr, real_path_cstr) != NULL) {
+    real_path = str_from_c(real_path_cstr);
+    cache_path = jvm_class_path_cache_path(real_path, &scratch_arena);
+  }
+
+  if (!str_is_empty(cache_path) &&
+      jvm_open_class_path_cache(&archive.cache, real_path, &archive_stat,
+                                cache_path, scratch_arena)) {
+    LOG("Using class path cache=%.*s archive=%.*s", (int)cache_path.len,
+        cache_path.data, (int)path.len, path.data);
+  } else {
+    archive.entries = jvm_buf_read_jar_central_directory(content, arena);
+
+    if (!str_is_empty(cache_path) &&
+        jvm_write_class_path_cache(&archive, real_path, &archive_stat,
+                                   cache_path, scratch_arena) &&
+        jvm_open_class_path_cache(&archive.cache, real_path, &archive_stat,
+                                  cache_path, scratch_arena)) {
+      LOG("Created class path cache=%.*s archive=%.*s", (int)cache_path.len,
+          cache_path.data, (int)path.len, path.data);
+    }
   }
 
-  content = str_advance(content, 4);
-  const bool success =
-      jvm_buf_read_jar_file(resolver, content, path, scratch_arena, arena);
+  if (archive.cache.header != NULL) {
+    archive.entries = (Array(Jar_entry)){0};
+    munmap(read_res.content.data, read_res.content.len);
+
+    if (archive.cache.header->classes_len > 0)
+      archive.cache_classes_loaded =
+          arena_alloc(arena, sizeof(bool), _Alignof(bool),
+                      archive.cache.header->classes_len);
+  } else {
+    for (u32 i = 0; i < archive.entries.len; i++) {
+      const Str class_name = jar_archive_class_name(&archive, i);
+      if (str_is_empty(class_name))
+        continue;
+
+      Jar_class_index **const slot =
+          jar_class_index_find(&archive.class_index, class_name);
+      if (*slot != NULL)
+        continue; // Duplicate entry: the first one wins.
+
+      *slot = arena_alloc(arena, sizeof(Jar_class_index),
+                          _Alignof(Jar_class_index), 1);
+      (*slot)->class_name = class_name;
+      (*slot)->entry_i = i;
+    }
+  }
 
-  munmap(read_res.content.data, read_res.content.len);
+  LOG("Opened archive=%.*s classes=%u", (int)path.len, path.data,
+      jar_archive_classes_len(&archive));
 
-  return success;
+  *array_push(&resolver->archives, arena) = archive;
+  return true;
 }
 
-static bool jvm_read_jar_file(Resolver *resolver, Str path, Arena scratch_arena,
-                              Arena *arena) {
+// Load the class with this fully qualified name e.g. `kotlin.io.ConsoleKt` if
+// the archive has it.
+static void resolver_load_archive_class(Resolver *resolver,
+                                        Jar_archive *archive, Str fqn,
+                                        Arena scratch_arena, Arena *arena) {
+  pg_assert(resolver != NULL);
+  pg_assert(archive != NULL);
+
+  const i64 class_i = jar_archive_find_class(archive, fqn);
+  if (class_i == -1)
+    return;
+
+  Array(u32) class_indices = array_make(u32, 0, 1, &scratch_arena);
+  *array_push(&class_indices, &scratch_arena) = (u32)class_i;
+
+  resolver_load_jar_entries(resolver, archive, class_indices, scratch_arena,
+                            arena);
+}
+
+// Callables are looked up by name across all imported packages, so all the
+// classes of these packages have to be loaded first.
+static void resolver_load_imported_packages(Resolver *resolver,
+                                            Arena scratch_arena,
+                                            Arena *arena) {
   pg_assert(resolver != NULL);
   pg_assert(arena != NULL);
 
-  char *path_cstr = str_to_c(path, &scratch_arena);
-  Read_result read_res = ut_file_mmap(path_cstr);
-  if (read_res.error) {
-    fprintf(stderr, "Failed to read the file %.*s: %s\n", (int)path.len,
-            path.data, strerror(read_res.error));
-    return false;
-  }
+  for (u64 i = 0; i < resolver->archives.len; i++) {
+    Jar_archive *const archive = &resolver->archives.data[i];
+    if (archive->imported_packages_loaded)
+      continue;
 
-  const bool success = jvm_buf_read_jar_file(resolver, read_res.content, path,
-                                             scratch_arena, arena);
-  munmap(read_res.content.data, read_res.content.len);
+    archive->imported_packages_loaded = true;
 
-  return success;
+    Arena tmp_arena = scratch_arena;
+    const u32 classes_len = jar_archive_classes_len(archive);
+    Array(u32) class_indices = array_make(u32, 0, classes_len, &tmp_arena);
+
+    for (u32 j = 0; j < classes_len; j++) {
+      const Str class_name = jar_archive_class_name(archive, j);
+      if (str_is_empty(class_name))
+        continue;
+
+      const Str_split_result slash_split = str_rsplit(class_name, '/');
+      const Str package_name = slash_split.found ? slash_split.left : (Str){0};
+
+      for (u64 k = 0; k < resolver->imported_package_names.len; k++) {
+        if (jvm_class_names_equal(package_name,
+                                  resolver->imported_package_names.data[k])) {
+          *array_push(&class_indices, &tmp_arena) = j;
+          break;
+        }
+      }
+    }
+
+    resolver_load_jar_entries(resolver, archive, class_indices, tmp_arena,
+                              arena);
+  }
 }
 
 static bool resolver_is_package_imported(const Resolver *resolver,
@@ -5569,7 +7696,6 @@ static bool resolver_is_package_imported(const Resolver *resolver,
   return false;
 }
 
-// TODO: Keep an hashtable/hashtrie of callables by name.
 static void resolver_collect_callables_with_name(const Resolver *resolver,
                                                  Str function_name,
                                                  Array(Type_handle) *
@@ -5578,27 +7704,24 @@ static void resolver_collect_callables_with_name(const Resolver *resolver,
   pg_assert(resolver != NULL);
   pg_assert(candidate_functions_i != NULL);
 
-  for (Type_handle handle = resolver->first_type->list_next;
+  for (Type_handle handle = type_index_get_first(resolver->callables_index,
+                                                 (Str){0}, function_name);
        !type_handle_handles_nil(handle);
-       handle = type_handle_to_ptr(handle, *arena)->list_next) {
+       handle = type_handle_to_ptr(handle, *arena)->index_next) {
     Type *const type = type_handle_to_ptr(handle, *arena);
+    pg_assert(type->kind == TYPE_METHOD || type->kind == TYPE_CONSTRUCTOR);
 
-    if (type->kind == TYPE_METHOD || type->kind == TYPE_CONSTRUCTOR) {
-      const Method *const method = &type->v.method;
-
-      if ((method->access_flags & ACCESS_FLAGS_STATIC) == 0)
-        continue;
+    const Method *const method = &type->v.method;
 
-      if (!str_eq(method->name, function_name))
-        continue;
+    if ((method->access_flags & ACCESS_FLAGS_STATIC) == 0)
+      continue;
 
-      // TODO: Should loaded but not yet imported types reside in a different
-      // array to avoid thrashing?
-      if (!resolver_is_package_imported(resolver, type->package_name))
-        continue;
+    // TODO: Should loaded but not yet imported types reside in a different
+    // index to avoid thrashing?
+    if (!resolver_is_package_imported(resolver, type->package_name))
+      continue;
 
-      *array_push(candidate_functions_i, arena) = handle;
-    }
+    *array_push(candidate_functions_i, arena) = handle;
   }
 
   // TODO: Collect callable fields as well.
@@ -5808,6 +7931,7 @@ resolver_resolve_free_function(Resolver *resolver, Str method_name,
   pg_assert(method_name.len > 0);
   pg_assert(picked_method_type_handle != NULL);
 
+  resolver_load_imported_packages(resolver, scratch_arena, arena);
   resolver_collect_callables_with_name(resolver, method_name,
                                        candidate_functions_i, arena);
 
@@ -5898,16 +8022,15 @@ static bool typechecker_merge_types(const Resolver *resolver,
   return false;
 }
 
-static void resolver_ast_fprint(const Resolver *resolver, Ast_handle ast_handle,
-                                FILE *file, u16 indent, u32 count,
-                                Arena scratch_arena, Arena handles_arena) {
+static void resolver_ast_print(const Resolver *resolver, Ast_handle ast_handle,
+                               Str_builder *out, Arena *out_arena, u16 indent,
+                               u32 count, Arena scratch_arena,
+                               Arena handles_arena) {
   pg_assert(resolver != NULL);
   pg_assert(resolver->parser != NULL);
   pg_assert(resolver->parser->lexer != NULL);
   pg_assert(resolver->parser->tokens_i <= resolver->parser->lexer->tokens.len);
-
-  if (!cli_log_verbose)
-    return;
+  pg_assert(out != NULL);
 
   if (ast_handle_is_nil(ast_handle))
     return;
@@ -5918,14 +8041,13 @@ static void resolver_ast_fprint(const Resolver *resolver, Ast_handle ast_handle,
 
   const Str kind_string = ast_kind_to_string[node->kind];
   const Token token = resolver->parser->lexer->tokens.data[node->main_token_i];
+  const Str file_path = resolver->parser->lexer->file_path;
   u32 line = 0;
   u32 column = 0;
   Str token_string = {0};
   parser_find_token_position(resolver->parser, token, &line, &column,
                              &token_string);
 
-  ut_fwrite_indent(file, indent);
-
   const char *const type_kind =
       typechecker_type_kind_string(node->type_handle, scratch_arena);
 
@@ -5934,78 +8056,140 @@ static void resolver_ast_fprint(const Resolver *resolver, Ast_handle ast_handle,
   case AST_KIND_BOOL: {
     const Str human_type =
         type_to_human_string(node->type_handle, &scratch_arena, handles_arena);
-    LOG("[%u] %.*s %.*s: %.*s (%s) (at %.*s:%u:%u:%u)", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)human_type.len, human_type.data, type_kind,
-        (int)resolver->parser->lexer->file_path.len,
-        resolver->parser->lexer->file_path.data, line, column,
-        token.source_offset);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s: %.*s (%s) (at %.*s:%u:%u:%u)\n",
+        indent, "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)human_type.len,
+        human_type.data, type_kind, (int)file_path.len, file_path.data, line,
+        column, token.source_offset);
     break;
   }
 
   case AST_KIND_LIST: {
     const Str human_type =
         type_to_human_string(node->type_handle, &scratch_arena, handles_arena);
-    LOG("[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u), %u children", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)human_type.len, human_type.data, type_kind,
-        (int)resolver->parser->lexer->file_path.len,
-        resolver->parser->lexer->file_path.data, line, column,
-        token.source_offset, node->nodes.len);
+    *out = sb_append_fmt(
+        *out, out_arena,
+        "%*s[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u), %u children\n", indent,
+        "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)human_type.len,
+        human_type.data, type_kind, (int)file_path.len, file_path.data, line,
+        column, token.source_offset, node->nodes.len);
 
     for (u64 i = 0; i < node->nodes.len; i++)
-      resolver_ast_fprint(resolver, node->nodes.data[i], file, indent + 2,
-                          ++count, scratch_arena, handles_arena);
+      resolver_ast_print(resolver, node->nodes.data[i], out, out_arena,
+                         indent + 2, ++count, scratch_arena, handles_arena);
     break;
   }
   case AST_KIND_CALL: {
     const Str human_type = resolver_function_to_human_string(
         node->type_handle, &scratch_arena, handles_arena);
-    LOG("[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u), %u children", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)human_type.len, human_type.data, type_kind,
-        (int)resolver->parser->lexer->file_path.len,
-        resolver->parser->lexer->file_path.data, line, column,
-        token.source_offset, node->nodes.len);
+    *out = sb_append_fmt(
+        *out, out_arena,
+        "%*s[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u), %u children\n", indent,
+        "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)human_type.len,
+        human_type.data, type_kind, (int)file_path.len, file_path.data, line,
+        column, token.source_offset, node->nodes.len);
 
     for (u64 i = 0; i < node->nodes.len; i++)
-      resolver_ast_fprint(resolver, node->nodes.data[i], file, indent + 2,
-                          ++count, scratch_arena, handles_arena);
+      resolver_ast_print(resolver, node->nodes.data[i], out, out_arena,
+                         indent + 2, ++count, scratch_arena, handles_arena);
     break;
   }
   default: {
     const Str human_type =
         type_to_human_string(node->type_handle, &scratch_arena, handles_arena);
-    LOG("[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u)", count,
-        (int)kind_string.len, kind_string.data, (int)token_string.len,
-        token_string.data, (int)human_type.len, human_type.data, type_kind,
-        (int)resolver->parser->lexer->file_path.len,
-        resolver->parser->lexer->file_path.data, line, column,
-        token.source_offset);
-    resolver_ast_fprint(resolver, node->lhs, file, indent + 2, ++count,
-                        scratch_arena, handles_arena);
-    resolver_ast_fprint(resolver, node->rhs, file, indent + 2, ++count,
-                        scratch_arena, handles_arena);
+    *out = sb_append_fmt(
+        *out, out_arena, "%*s[%u] %.*s %.*s: %.*s %s (at %.*s:%u:%u:%u)\n",
+        indent, "", count, (int)kind_string.len, kind_string.data,
+        (int)token_string.len, token_string.data, (int)human_type.len,
+        human_type.data, type_kind, (int)file_path.len, file_path.data, line,
+        column, token.source_offset);
+    resolver_ast_print(resolver, node->lhs, out, out_arena, indent + 2,
+                       ++count, scratch_arena, handles_arena);
+    resolver_ast_print(resolver, node->rhs, out, out_arena, indent + 2,
+                       ++count, scratch_arena, handles_arena);
     break;
   }
   }
 }
 
-static bool type_fqn_equal_to_package_and_name(Str a_fqn, Str b_package_name,
-                                               Str b_class_name,
-                                               Arena scratch_arena) {
-  pg_assert(!str_contains_element(b_class_name, (u8)'/'));
-  pg_assert(!str_contains_element(b_class_name, (u8)'.'));
+// Lookup a type already loaded by its fully qualified name e.g.
+// `kotlin.io.ConsoleKt`.
+static Type_handle resolver_find_loaded_type(const Resolver *resolver,
+                                             Str fqn) {
+  const Str_split_result dot_split = str_rsplit(fqn, '.');
+  const Str package_name = dot_split.found ? dot_split.left : (Str){0};
+  const Str class_name = dot_split.right;
+
+  return type_index_get_first(resolver->instance_types_index, package_name,
+                              class_name);
+}
+
+// List the `.class` files of the package directory e.g. `kotlin/io`, once.
+static void class_path_directory_list_package(Class_path_directory *directory,
+                                              Str package_path,
+                                              Arena scratch_arena,
+                                              Arena *arena) {
+  pg_assert(directory != NULL);
+  pg_assert(arena != NULL);
+
+  Jar_class_index **const package_slot =
+      jar_class_index_find(&directory->listed_packages, package_path);
+  if (*package_slot != NULL)
+    return;
+
+  *package_slot = arena_alloc(arena, sizeof(Jar_class_index),
+                              _Alignof(Jar_class_index), 1);
+  (*package_slot)->class_name = str_clone(package_path, arena);
+
+  Str_builder path = sb_new(directory->path.len + 1 + package_path.len,
+                            &scratch_arena);
+  path = sb_append(path, directory->path, &scratch_arena);
+  if (!str_is_empty(package_path)) {
+    path = sb_append_char(path, '/', &scratch_arena);
+    path = sb_append(path, package_path, &scratch_arena);
+  }
+
+  DIR *const dir = opendir((char *)path.data);
+  if (dir == NULL) // Silently skip missing directories.
+    return;
+
+  const Str extension = str_from_c(".class");
+  u64 count = 0;
+  for (struct dirent *dirent = readdir(dir); dirent != NULL;
+       dirent = readdir(dir)) {
+    if (dirent->d_type == DT_DIR)
+      continue;
+
+    Str file_name = str_from_c(dirent->d_name);
+    if (!str_ends_with(file_name, extension))
+      continue;
+    file_name.len -= extension.len;
+
+    Str_builder class_name =
+        sb_new(package_path.len + 1 + file_name.len, arena);
+    if (!str_is_empty(package_path)) {
+      class_name = sb_append(class_name, package_path, arena);
+      class_name = sb_append_char(class_name, '/', arena);
+    }
+    class_name = sb_append(class_name, file_name, arena);
+
+    Jar_class_index **const slot =
+        jar_class_index_find(&directory->class_index, sb_build(class_name));
+    if (*slot != NULL)
+      continue;
 
-  Str_builder b_fqn =
-      sb_new(b_package_name.len + 1 + b_class_name.len, &scratch_arena);
-  if (!str_is_empty(b_package_name)) {
-    b_fqn = sb_append(b_fqn, b_package_name, &scratch_arena);
-    b_fqn = sb_append_char(b_fqn, '.', &scratch_arena);
+    *slot = arena_alloc(arena, sizeof(Jar_class_index),
+                        _Alignof(Jar_class_index), 1);
+    (*slot)->class_name = sb_build(class_name);
+    count += 1;
   }
-  b_fqn = sb_append(b_fqn, b_class_name, &scratch_arena);
+  closedir(dir);
 
-  return str_eq(a_fqn, sb_build(b_fqn));
+  LOG("Listed class path directory=%.*s classes=%lu", (int)path.len,
+      path.data, count);
 }
 
 static bool resolver_resolve_fully_qualified_name(Resolver *resolver, Str fqn,
@@ -6023,78 +8207,86 @@ static bool resolver_resolve_fully_qualified_name(Resolver *resolver, Str fqn,
   // TODO: Flag types coming from java as nullable.
 
   // Check if cached first.
-  // TODO: Keep an hashtable/hashtrie of non callable types by package/name.
-  for (Type_handle handle = resolver->first_type->list_next;
-       !type_handle_handles_nil(handle);
-       handle = type_handle_to_ptr(handle, *arena)->list_next) {
-    const Type *const type = type_handle_to_ptr(handle, *arena);
-
-    if (type->kind == TYPE_METHOD || type->kind == TYPE_CONSTRUCTOR)
-      continue;
-
-    if (type->kind == TYPE_INSTANCE &&
-        type_fqn_equal_to_package_and_name(
-            fqn, type->package_name, type->this_class_name, scratch_arena)) {
+  {
+    const Type_handle handle = resolver_find_loaded_type(resolver, fqn);
+    if (!type_handle_handles_nil(handle)) {
       *type_handle = handle;
       return true;
     }
   }
 
-  // Scan the class path entries for `$CLASS_PATH_ENTRY/$CLASS_NAME.class`.
-  // E.g.: `/usr/share/java/kotlin-stdlib.jar` -> `/usr/share/java/Fqn.class`.
-  for (u64 i = 0; i < resolver->class_path_entries.len; i++) {
-    const Str entry = resolver->class_path_entries.data[i];
-    Str_split_result entry_last_slash_split = str_rsplit(entry, '/');
-    const Str parent = entry_last_slash_split.left;
-
-    const Str final_extension = str_from_c(".class");
-
-    Str_builder tentative_class_file_path_builder =
-        sb_new(parent.len + 1 + fqn.len + final_extension.len, arena);
-
-    tentative_class_file_path_builder =
-        sb_append(tentative_class_file_path_builder, parent, arena);
-    tentative_class_file_path_builder =
-        sb_append_char(tentative_class_file_path_builder, '/', arena);
-
-    {
-      u64 replace_start = tentative_class_file_path_builder.len;
+  // Look for `$CLASS_NAME.class` in the jmod files (standard library).
+  for (u64 i = 0; i < resolver->archives.len; i++) {
+    Jar_archive *const archive = &resolver->archives.data[i];
+    if (!str_ends_with_c(archive->path, ".jmod"))
+      continue;
 
-      // Transform e.g. `/a/b/kotlin.io.ConsoleKt` into
-      // `/a/b/kotlin/io/ConsoleKt`.
-      tentative_class_file_path_builder =
-          sb_append(tentative_class_file_path_builder, fqn, arena);
+    resolver_load_archive_class(resolver, archive, fqn, scratch_arena, arena);
 
-      tentative_class_file_path_builder = sb_replace_element_starting_at(
-          tentative_class_file_path_builder, replace_start, '.', '/');
+    const Type_handle handle = resolver_find_loaded_type(resolver, fqn);
+    if (!type_handle_handles_nil(handle)) {
+      *type_handle = handle;
+      return true;
     }
+  }
+
+  // Look for `$CLASS_PATH_DIRECTORY/$CLASS_NAME.class`, only touching the file
+  // system for classes which are known to exist.
+  {
+    // E.g. `kotlin.io.ConsoleKt` -> `kotlin/io/ConsoleKt`.
+    Str_builder class_path_builder = sb_new(fqn.len, &scratch_arena);
+    class_path_builder = sb_append(class_path_builder, fqn, &scratch_arena);
+    class_path_builder =
+        sb_replace_element_starting_at(class_path_builder, 0, '.', '/');
+    const Str class_path = sb_build(class_path_builder);
+
+    const Str_split_result class_path_split = str_rsplit(class_path, '/');
+    const Str package_path =
+        class_path_split.found ? class_path_split.left : (Str){0};
+
+    for (u64 i = 0; i < resolver->class_path_directories.len; i++) {
+      Class_path_directory *const directory =
+          &resolver->class_path_directories.data[i];
+
+      class_path_directory_list_package(directory, package_path, scratch_arena,
+                                        arena);
+      if (*jar_class_index_find(&directory->class_index, class_path) == NULL)
+        continue;
 
-    tentative_class_file_path_builder =
-        sb_append(tentative_class_file_path_builder, final_extension, arena);
-    const Str tentative_class_file_path =
-        sb_build(tentative_class_file_path_builder);
+      const Str final_extension = str_from_c(".class");
+      Str_builder class_file_path_builder = sb_new(
+          directory->path.len + 1 + class_path.len + final_extension.len,
+          arena);
+      class_file_path_builder =
+          sb_append(class_file_path_builder, directory->path, arena);
+      class_file_path_builder =
+          sb_append_char(class_file_path_builder, '/', arena);
+      class_file_path_builder =
+          sb_append(class_file_path_builder, class_path, arena);
+      class_file_path_builder =
+          sb_append(class_file_path_builder, final_extension, arena);
+      const Str class_file_path = sb_build(class_file_path_builder);
 
-    {
       // TODO: check if we can read the file content into `scratch_arena`
-      char *tentative_class_file_path_cstr =
-          str_to_c(tentative_class_file_path, &scratch_arena);
-      Read_result read_res = ut_file_mmap(tentative_class_file_path_cstr);
+      Read_result read_res =
+          ut_file_mmap(str_to_c(class_file_path, &scratch_arena));
       if (read_res.error) // Silently swallow the error and skip this entry.
         continue;
 
       Class_file class_file = {
-          .class_file_path = tentative_class_file_path,
+          .class_file_path = class_file_path,
+          .lazy_attributes = true,
+          .lazy_constants = true,
       };
-      u8 *current = read_res.content.data;
-      jvm_buf_read_class_file(read_res.content, &current, &class_file, arena);
-
-      pg_assert(str_eq(fqn, class_file.class_name));
+      if (!jvm_buf_read_class_file(read_res.content, &class_file, arena)) {
+        munmap(read_res.content.data, read_res.content.len);
+        continue; // Already reported, skip this entry.
+      }
 
-      Type this_type = {.kind = TYPE_INSTANCE};
-      type_init_package_and_name(class_file.class_name, &this_type.package_name,
-                                 &this_type.this_class_name, arena);
+      pg_assert(jvm_class_names_equal(fqn, class_file.class_name));
 
-      *type_handle = resolver_add_type(resolver, &this_type, arena);
+      *type_handle =
+          resolver_load_class_file(resolver, &class_file, "file", arena);
 
       munmap(read_res.content.data, read_res.content.len);
 
@@ -6102,29 +8294,18 @@ static bool resolver_resolve_fully_qualified_name(Resolver *resolver, Str fqn,
     }
   }
 
-  // Scan the class path entries for `$CLASS_PATH_ENTRY` which is a jar file
-  // that contains
-  // `$CLASS_NAME.class`.
-  for (u64 i = 0; i < resolver->class_path_entries.len; i++) {
-    Arena _scratch_arena = scratch_arena;
-
-    const Str class_path_entry = resolver->class_path_entries.data[i];
-    if (!str_ends_with(class_path_entry, str_from_c(".jar")))
+  // Look for `$CLASS_NAME.class` in the jar files.
+  for (u64 i = 0; i < resolver->archives.len; i++) {
+    Jar_archive *const archive = &resolver->archives.data[i];
+    if (str_ends_with_c(archive->path, ".jmod"))
       continue;
 
-    jvm_read_jar_file(resolver, class_path_entry, _scratch_arena, arena);
-
-    for (Type_handle handle = resolver->first_type->list_next;
-         !type_handle_handles_nil(handle);
-         handle = type_handle_to_ptr(handle, *arena)->list_next) {
-      Type *const type = type_handle_to_ptr(handle, *arena);
+    resolver_load_archive_class(resolver, archive, fqn, scratch_arena, arena);
 
-      if (type->kind == TYPE_INSTANCE &&
-          type_fqn_equal_to_package_and_name(
-              fqn, type->package_name, type->this_class_name, _scratch_arena)) {
-        *type_handle = handle;
-        return true;
-      }
+    const Type_handle handle = resolver_find_loaded_type(resolver, fqn);
+    if (!type_handle_handles_nil(handle)) {
+      *type_handle = handle;
+      return true;
     }
   }
 
@@ -6170,7 +8351,33 @@ static void resolver_load_standard_types(Resolver *resolver, Str java_home,
   path = sb_append(path, java_home, arena);
   path = sb_append(path, relative_jmod_path, arena);
 
-  jvm_read_jmod_file(resolver, sb_build(path), scratch_arena, arena);
+  resolver_open_archive(resolver, sb_build(path), scratch_arena, arena);
+
+  for (u64 i = 0; i < resolver->class_path_entries.len; i++) {
+    const Str class_path_entry = resolver->class_path_entries.data[i];
+    const bool is_jar = str_ends_with(class_path_entry, str_from_c(".jar"));
+    if (is_jar)
+      resolver_open_archive(resolver, class_path_entry, scratch_arena, arena);
+
+    // Class files next to a jar are also found e.g.
+    // `/usr/share/java/kotlin-stdlib.jar` -> `/usr/share/java/Fqn.class`.
+    Str directory_path = class_path_entry;
+    if (is_jar) {
+      const Str_split_result last_slash_split =
+          str_rsplit(class_path_entry, '/');
+      directory_path =
+          last_slash_split.found ? last_slash_split.left : str_from_c(".");
+    }
+
+    bool seen = false;
+    for (u64 j = 0; j < resolver->class_path_directories.len; j++)
+      seen |= str_eq(resolver->class_path_directories.data[j].path,
+                     directory_path);
+
+    if (!seen)
+      *array_push(&resolver->class_path_directories, arena) =
+          (Class_path_directory){.path = directory_path};
+  }
 
   const Str sanity_check = str_from_c("kotlin.io.ConsoleKt");
   if (!resolver_resolve_fully_qualified_name(
@@ -6955,8 +9162,13 @@ typedef struct {
   codegen_frame *frame;
   Array(Codegen_scope_variable) locals;
   Array(Stack_map_frame) stack_map_frames;
+  // Offsets in the bytecode of the constant pool indices, to remap them when
+  // merging constant pools.
+  Array(u32) constant_pool_relocations;
+  // Of the current method, see `codegen_record_line_number`.
+  Array(Jvm_line_number_table_entry) line_numbers;
   u32 scope_id;
-  pg_pad(4);
+  u32 line_cursor; // See `lex_find_line_index_from`.
 } codegen_generator;
 
 // FIXME: Probably should not behave like a FIFO and rather like an array.
@@ -6989,7 +9201,17 @@ static void codegen_frame_locals_push(codegen_generator *gen,
   *array_push(&gen->locals, arena) = scope_variable;
 }
 
-static u16 codegen_import_constant(Array(Jvm_constant_pool_entry) * dst,
+static void codegen_emit_constant_pool_index(codegen_generator *gen,
+                                             u16 constant_i, Arena *arena) {
+  pg_assert(gen != NULL);
+  pg_assert(gen->code != NULL);
+  pg_assert(constant_i > 0);
+
+  *array_push(&gen->constant_pool_relocations, arena) = gen->code->bytecode.len;
+  jvm_code_array_push_u16(&gen->code->bytecode, constant_i, arena);
+}
+
+static u16 codegen_import_constant(Class_file *dst,
                                    Array(Jvm_constant_pool_entry) src,
                                    u16 constant_i, Arena *arena) {
   const Jvm_constant_pool_entry *const constant =
@@ -7012,10 +9234,22 @@ static u16 codegen_import_constant(Array(Jvm_constant_pool_entry) * dst,
   }
 
   case CONSTANT_POOL_KIND_INT:
+  case CONSTANT_POOL_KIND_FLOAT:
+  case CONSTANT_POOL_KIND_LONG:
+  case CONSTANT_POOL_KIND_DOUBLE:
   case CONSTANT_POOL_KIND_UTF8: {
     return jvm_constant_pool_push(dst, constant, arena);
   }
 
+  case CONSTANT_POOL_KIND_STRING: {
+    const Jvm_constant_pool_entry constant_gen = {
+        .kind = constant->kind,
+        .v.string_utf8_i = codegen_import_constant(
+            dst, src, constant->v.string_utf8_i, arena),
+    };
+    return jvm_constant_pool_push(dst, &constant_gen, arena);
+  }
+
   case CONSTANT_POOL_KIND_CLASS_INFO: {
     const Jvm_constant_pool_entry constant_gen = {
         .kind = constant->kind,
@@ -7220,7 +9454,7 @@ static void codegen_emit_ldc(codegen_generator *gen,
       jvm_constant_pool_get(constant_pool, constant_i);
   switch (constant->kind) {
   case CONSTANT_POOL_KIND_INT:
-    jvm_code_array_push_u16(&gen->code->bytecode, constant_i, arena);
+    codegen_emit_constant_pool_index(gen, constant_i, arena);
     codegen_frame_stack_push(
         gen->frame, (Jvm_verification_info){.kind = VERIFICATION_INFO_INT},
         arena);
@@ -7257,7 +9491,7 @@ static void codegen_emit_get_static(codegen_generator *gen, u16 field_i,
   pg_assert(arena != NULL);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_GET_STATIC, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, field_i, arena);
+  codegen_emit_constant_pool_index(gen, field_i, arena);
 
   pg_assert(gen->frame->stack.len < UINT16_MAX);
 
@@ -7279,7 +9513,7 @@ static void codegen_emit_invoke_virtual(codegen_generator *gen,
   pg_assert(gen->frame->stack.len <= UINT16_MAX);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_INVOKE_VIRTUAL, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, method_ref_i, arena);
+  codegen_emit_constant_pool_index(gen, method_ref_i, arena);
 
   for (u8 i = 0; i < 1 + method_type->argument_type_handles.len; i++)
     codegen_frame_stack_pop(gen->frame);
@@ -7307,7 +9541,7 @@ static void codegen_emit_invoke_static(codegen_generator *gen, u16 method_ref_i,
   pg_assert(gen->frame->stack.len <= UINT16_MAX);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_INVOKE_STATIC, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, method_ref_i, arena);
+  codegen_emit_constant_pool_index(gen, method_ref_i, arena);
 
   for (u8 i = 0; i < method_type->argument_type_handles.len; i++)
     codegen_frame_stack_pop(gen->frame);
@@ -7336,7 +9570,7 @@ static void codegen_emit_invoke_special(codegen_generator *gen,
   pg_assert(gen->frame->stack.len <= UINT16_MAX);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_INVOKE_SPECIAL, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, method_ref_i, arena);
+  codegen_emit_constant_pool_index(gen, method_ref_i, arena);
 
   for (u8 i = 0; i < method_type->argument_type_handles.len; i++)
     codegen_frame_stack_pop(gen->frame);
@@ -7398,9 +9632,8 @@ static void codegen_emit_inlined_method_call(codegen_generator *gen,
     case BYTECODE_GET_STATIC: {
       const u16 field_ref_i =
           buf_read_be_u16(str_new(code.data, code_size), &current);
-      const u16 field_ref_gen_i =
-          codegen_import_constant(&class_file->constant_pool,
-                                  method->constant_pool, field_ref_i, arena);
+      const u16 field_ref_gen_i = codegen_import_constant(
+          class_file, method->constant_pool, field_ref_i, arena);
 
       const Jvm_constant_pool_entry *const field_ref_gen =
           jvm_constant_pool_get(class_file->constant_pool, field_ref_gen_i);
@@ -7414,9 +9647,8 @@ static void codegen_emit_inlined_method_call(codegen_generator *gen,
     case BYTECODE_INVOKE_VIRTUAL: {
       const u16 method_ref_i =
           buf_read_be_u16(str_new(code.data, code_size), &current);
-      const u16 method_ref_gen_i =
-          codegen_import_constant(&class_file->constant_pool,
-                                  method->constant_pool, method_ref_i, arena);
+      const u16 method_ref_gen_i = codegen_import_constant(
+          class_file, method->constant_pool, method_ref_i, arena);
 
       const Type_handle invoked_type_handle =
           codegen_make_type_from_method_descriptor(
@@ -7486,7 +9718,7 @@ static void codegen_emit_inlined_method_call(codegen_generator *gen,
       const u16 constant_i =
           (u16)buf_read_u8(str_new(code.data, code_size), &current);
       const u16 constant_gen_i = codegen_import_constant(
-          &class_file->constant_pool, method->constant_pool, constant_i, arena);
+          class_file, method->constant_pool, constant_i, arena);
 
       codegen_emit_ldc(gen, class_file->constant_pool, constant_gen_i, arena);
 
@@ -7500,9 +9732,8 @@ static void codegen_emit_inlined_method_call(codegen_generator *gen,
     case BYTECODE_INVOKE_STATIC: {
       const u16 method_ref_i =
           buf_read_be_u16(str_new(code.data, code_size), &current);
-      const u16 method_ref_gen_i =
-          codegen_import_constant(&class_file->constant_pool,
-                                  method->constant_pool, method_ref_i, arena);
+      const u16 method_ref_gen_i = codegen_import_constant(
+          class_file, method->constant_pool, method_ref_i, arena);
 
       const Type_handle invoked_type_handle =
           codegen_make_type_from_method_descriptor(
@@ -7713,7 +9944,7 @@ codegen_emit_load_constant_single_word(codegen_generator *gen, u16 constant_i,
   pg_assert(jvm_verification_info_kind_word_count(verification_info.kind) == 1);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_LDC_W, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, constant_i, arena);
+  codegen_emit_constant_pool_index(gen, constant_i, arena);
 
   pg_assert(gen->frame->stack.len < UINT16_MAX);
 
@@ -7732,7 +9963,7 @@ codegen_emit_load_constant_double_word(codegen_generator *gen, u16 constant_i,
   pg_assert(jvm_verification_info_kind_word_count(verification_info.kind) == 2);
 
   jvm_code_push_u8(&gen->code->bytecode, BYTECODE_LDC2_W, arena);
-  jvm_code_array_push_u16(&gen->code->bytecode, constant_i, arena);
+  codegen_emit_constant_pool_index(gen, constant_i, arena);
 
   pg_assert(gen->frame->stack.len < UINT16_MAX);
 
@@ -8231,16 +10462,49 @@ __attribute__((unused)) static u16
 codegen_add_class_name_in_constant_pool(Class_file *class_file, Str class_name,
                                         Arena *arena) {
   const u16 class_name_i =
-      jvm_add_constant_string(&class_file->constant_pool, class_name, arena);
+      jvm_add_constant_string(class_file, class_name, arena);
   const Jvm_constant_pool_entry out_class = {
       .kind = CONSTANT_POOL_KIND_CLASS_INFO,
       .v = {.java_class_name = class_name_i}};
-  const u16 class_i =
-      jvm_constant_pool_push(&class_file->constant_pool, &out_class, arena);
+  const u16 class_i = jvm_constant_pool_push(class_file, &out_class, arena);
 
   return class_i;
 }
 
+// Map the current bytecode offset to the line of the statement starting at
+// `source_offset`. Statements are emitted in source order, so finding the line
+// is usually a few steps from the previous one.
+static void codegen_record_line_number(codegen_generator *gen,
+                                       u32 source_offset, Arena *arena) {
+  pg_assert(gen != NULL);
+  pg_assert(gen->code != NULL);
+
+  const u32 line_i = lex_find_line_index_from(gen->resolver->parser->lexer,
+                                              &gen->line_cursor, source_offset);
+  const u32 line = line_i + 1;
+  const u32 pc = gen->code->bytecode.len;
+  // Not representable.
+  if (line > UINT16_MAX || pc > UINT16_MAX)
+    return;
+
+  if (!array_is_empty(gen->line_numbers)) {
+    Jvm_line_number_table_entry *const last = array_last(gen->line_numbers);
+    if (last->line_number == line)
+      return;
+
+    // The previous statement emitted no bytecode.
+    if (last->start_pc == pc) {
+      last->line_number = (u16)line;
+      return;
+    }
+  }
+
+  *array_push(&gen->line_numbers, arena) = (Jvm_line_number_table_entry){
+      .start_pc = (u16)pc,
+      .line_number = (u16)line,
+  };
+}
+
 static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
                               Ast_handle ast_handle, Arena *arena) {
   pg_assert(gen != NULL);
@@ -8267,8 +10531,7 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
         .kind = CONSTANT_POOL_KIND_INT,
         .v.number = node->num,
     };
-    const u16 number_i =
-        jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
+    const u16 number_i = jvm_constant_pool_push(class_file, &constant, arena);
 
     pg_assert(gen->code != NULL);
     pg_assert(gen->frame != NULL);
@@ -8295,8 +10558,7 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
         .kind = pool_kind,
         .v.number = number,
     };
-    const u16 number_i =
-        jvm_constant_pool_push(&class_file->constant_pool, &constant, arena);
+    const u16 number_i = jvm_constant_pool_push(class_file, &constant, arena);
 
     if (pool_kind == CONSTANT_POOL_KIND_LONG ||
         pool_kind == CONSTANT_POOL_KIND_DOUBLE) {
@@ -8357,17 +10619,29 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
       // TODO: Support non static calls.
       pg_assert(type->v.method.access_flags & ACCESS_FLAGS_STATIC);
 
+      // The callee may be defined in another source file, thus class.
+      Str_builder callee_class_name = sb_new(
+          type->package_name.len + 1 + type->this_class_name.len, arena);
+      if (!str_is_empty(type->package_name)) {
+        callee_class_name =
+            sb_append(callee_class_name, type->package_name, arena);
+        callee_class_name =
+            sb_replace_element_starting_at(callee_class_name, 0, '.', '/');
+        callee_class_name = sb_append_char(callee_class_name, '/', arena);
+      }
+      callee_class_name =
+          sb_append(callee_class_name, type->this_class_name, arena);
+
       const Jvm_constant_pool_entry class_name = {
           .kind = CONSTANT_POOL_KIND_UTF8,
-          .v = {.s = gen->resolver->this_class_name}};
+          .v = {.s = sb_build(callee_class_name)}};
       const u16 class_name_i = jvm_constant_pool_push(
-          &class_file->constant_pool, &class_name, arena);
+          class_file, &class_name, arena);
 
       const Jvm_constant_pool_entry class = {
           .kind = CONSTANT_POOL_KIND_CLASS_INFO,
           .v = {.java_class_name = class_name_i}};
-      const u16 class_i =
-          jvm_constant_pool_push(&class_file->constant_pool, &class, arena);
+      const u16 class_i = jvm_constant_pool_push(class_file, &class, arena);
 
       const Jvm_constant_pool_entry name = {
           .kind = CONSTANT_POOL_KIND_UTF8,
@@ -8375,8 +10649,7 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
               .s = type->kind == TYPE_METHOD ? type->v.method.name
                                              : str_from_c(CONSTRUCTOR_JVM_NAME),
           }};
-      const u16 name_i =
-          jvm_constant_pool_push(&class_file->constant_pool, &name, arena);
+      const u16 name_i = jvm_constant_pool_push(class_file, &name, arena);
 
       Str_builder descriptor_s = sb_new(256, arena);
       descriptor_s =
@@ -8384,20 +10657,20 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
       const Jvm_constant_pool_entry descriptor = {
           .kind = CONSTANT_POOL_KIND_UTF8, .v = {.s = sb_build(descriptor_s)}};
       const u16 descriptor_i = jvm_constant_pool_push(
-          &class_file->constant_pool, &descriptor, arena);
+          class_file, &descriptor, arena);
 
       const Jvm_constant_pool_entry name_and_type = {
           .kind = CONSTANT_POOL_KIND_NAME_AND_TYPE,
           .v = {.name_and_type = {.name = name_i, .descriptor = descriptor_i}}};
       const u16 name_and_type_handle = jvm_constant_pool_push(
-          &class_file->constant_pool, &name_and_type, arena);
+          class_file, &name_and_type, arena);
 
       Jvm_constant_pool_entry method_ref = {
           .kind = CONSTANT_POOL_KIND_METHOD_REF,
           .v = {.ref = {.class = class_i,
                         .name_and_type = name_and_type_handle}}};
       const u16 method_ref_i = jvm_constant_pool_push(
-          &class_file->constant_pool, &method_ref, arena);
+          class_file, &method_ref, arena);
 
       if (type->kind == TYPE_METHOD)
         codegen_emit_invoke_static(gen, method_ref_i, &type->v.method, arena);
@@ -8422,13 +10695,13 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
         .data = &gen->resolver->parser->buf.data[token_name.source_offset],
     };
     const u16 method_name_i =
-        jvm_add_constant_string(&class_file->constant_pool, method_name, arena);
+        jvm_add_constant_string(class_file, method_name, arena);
 
     Str_builder descriptor = sb_new(64, arena);
     descriptor =
         jvm_fill_descriptor_string(descriptor, node->type_handle, arena);
     const u16 descriptor_i = jvm_add_constant_string(
-        &class_file->constant_pool, sb_build(descriptor), arena);
+        class_file, sb_build(descriptor), arena);
 
     Jvm_method method = {
         .access_flags = ACCESS_FLAGS_STATIC | ACCESS_FLAGS_PUBLIC,
@@ -8489,8 +10762,7 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
 
     Jvm_attribute attribute_stack_map_frames = {
         .kind = ATTRIBUTE_KIND_STACK_MAP_TABLE,
-        .name = jvm_add_constant_cstring(&class_file->constant_pool,
-                                         "StackMapTable", arena),
+        .name = jvm_add_constant_cstring(class_file, "StackMapTable", arena),
         .v.stack_map_table =
             array_make(Stack_map_frame, 0, gen->stack_map_frames.len, arena),
     };
@@ -8503,10 +10775,27 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
 
     *array_push(&code.attributes, arena) = attribute_stack_map_frames;
 
+    // A statement emitting no bytecode at the very end would point past it.
+    while (!array_is_empty(gen->line_numbers) &&
+           array_last(gen->line_numbers)->start_pc >= code.bytecode.len)
+      array_drop(&gen->line_numbers, 1);
+
+    if (!array_is_empty(gen->line_numbers)) {
+      Jvm_attribute attribute_line_numbers = {
+          .kind = ATTRIBUTE_KIND_LINE_NUMBER_TABLE,
+          .name =
+              jvm_add_constant_cstring(class_file, "LineNumberTable", arena),
+      };
+      array_clone(Jvm_line_number_table_entry,
+                  &attribute_line_numbers.v.line_number_table_entries,
+                  gen->line_numbers, arena);
+      *array_push(&code.attributes, arena) = attribute_line_numbers;
+    }
+
     const Jvm_attribute attribute_code = {
         .kind = ATTRIBUTE_KIND_CODE,
         .name =
-            jvm_add_constant_cstring(&class_file->constant_pool, "Code", arena),
+            jvm_add_constant_cstring(class_file, "Code", arena),
         .v = {.code = code}};
     *array_push(&method.attributes, arena) = attribute_code;
 
@@ -8515,6 +10804,7 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
     gen->code = NULL;
     gen->frame = NULL;
     array_clear(&gen->stack_map_frames);
+    array_clear(&gen->line_numbers);
     break;
   }
   case AST_KIND_UNARY: {
@@ -8764,9 +11054,16 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
     for (u64 i = 0; i < node->nodes.len; i++) {
       const Ast_handle child_handle = node->nodes.data[i];
 
+      const Ast *const child = ast_handle_to_ptr(child_handle, *arena);
+
       if (gen->frame != NULL) {
         pg_assert(array_is_empty(gen->frame->stack));
       }
+      if (gen->code != NULL) {
+        const Token child_token =
+            gen->resolver->parser->lexer->tokens.data[child->main_token_i];
+        codegen_record_line_number(gen, child_token.source_offset, arena);
+      }
       codegen_emit_node(gen, class_file, child_handle, arena);
 
       // If the 'statement' was in fact an expression, we need to pop it
@@ -8774,7 +11071,6 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
       // IMPROVEMENT: If we emit the pop earlier, some stack map frames
       // don't have to be a full_frame but can be something smaller e.g.
       // append_frame.
-      const Ast *const child = ast_handle_to_ptr(child_handle, *arena);
       if (child->kind != AST_KIND_RETURN && // Avoid: `return; pop;`
           gen->frame != NULL) {
         while (!array_is_empty(gen->frame->stack))
@@ -8878,24 +11174,21 @@ static void codegen_emit_node(codegen_generator *gen, Class_file *class_file,
         .data = gen->resolver->parser->buf.data + token.source_offset,
         .len = length,
     };
-    const u16 string_i =
-        jvm_add_constant_string(&class_file->constant_pool, s, arena);
-    const u16 jstring_i =
-        jvm_add_constant_jstring(&class_file->constant_pool, string_i, arena);
+    const u16 string_i = jvm_add_constant_string(class_file, s, arena);
+    const u16 jstring_i = jvm_add_constant_jstring(class_file, string_i, arena);
 
     // TODO: Deduplicate.
     const Jvm_constant_pool_entry string_class_info = {
         .kind = CONSTANT_POOL_KIND_CLASS_INFO,
         .v = {
-            .java_class_name =
-                jvm_add_constant_string(&class_file->constant_pool,
-                                        str_from_c("java/lang/String"), arena),
+            .java_class_name = jvm_add_constant_string(
+                class_file, str_from_c("java/lang/String"), arena),
         }};
 
     const Jvm_verification_info verification_info = {
         .kind = VERIFICATION_INFO_OBJECT,
-        .extra_data = jvm_constant_pool_push(&class_file->constant_pool,
-                                             &string_class_info, arena),
+        .extra_data =
+            jvm_constant_pool_push(class_file, &string_class_info, arena),
     };
     codegen_emit_load_constant_single_word(gen, jstring_i, verification_info,
                                            arena);
@@ -8989,20 +11282,20 @@ static void codegen_emit_synthetic_class(codegen_generator *gen,
 
   { // This class
     const u16 this_class_name_i = jvm_add_constant_string(
-        &class_file->constant_pool, gen->resolver->this_class_name, arena);
+        class_file, gen->resolver->this_class_name, arena);
 
     const Jvm_constant_pool_entry this_class_info = {
         .kind = CONSTANT_POOL_KIND_CLASS_INFO,
         .v = {
             .java_class_name = this_class_name_i,
         }};
-    class_file->this_class = jvm_constant_pool_push(&class_file->constant_pool,
-                                                    &this_class_info, arena);
+    class_file->this_class =
+        jvm_constant_pool_push(class_file, &this_class_info, arena);
   }
 
   { // Super class
     const u16 constant_java_lang_object_string_i = jvm_add_constant_cstring(
-        &class_file->constant_pool, "java/lang/Object", arena);
+        class_file, "java/lang/Object", arena);
 
     const Jvm_constant_pool_entry super_class_info = {
         .kind = CONSTANT_POOL_KIND_CLASS_INFO,
@@ -9010,8 +11303,22 @@ static void codegen_emit_synthetic_class(codegen_generator *gen,
             .java_class_name = constant_java_lang_object_string_i,
         }};
 
-    class_file->super_class = jvm_constant_pool_push(&class_file->constant_pool,
-                                                     &super_class_info, arena);
+    class_file->super_class =
+        jvm_constant_pool_push(class_file, &super_class_info, arena);
+  }
+
+  { // Source file, shown in stack traces.
+    const Str file_name =
+        str_rsplit(gen->resolver->parser->lexer->file_path, '/').right;
+    pg_assert(!str_is_empty(file_name));
+
+    const Jvm_attribute attribute_source_file = {
+        .kind = ATTRIBUTE_KIND_SOURCE_FILE,
+        .name = jvm_add_constant_cstring(class_file, "SourceFile", arena),
+        .v.source_file.source_file =
+            jvm_add_constant_string(class_file, file_name, arena),
+    };
+    *array_push(&class_file->attributes, arena) = attribute_source_file;
   }
 }
 
@@ -9091,7 +11398,7 @@ static void codegen_supplement_entrypoint_if_exists(codegen_generator *gen,
         .v.s = target_descriptor_string,
     };
     const u16 target_descriptor_i = jvm_constant_pool_push(
-        &class_file->constant_pool, &target_descriptor, arena);
+        class_file, &target_descriptor, arena);
 
     const Jvm_constant_pool_entry target_name_and_type = {
         .kind = CONSTANT_POOL_KIND_NAME_AND_TYPE,
@@ -9102,13 +11409,13 @@ static void codegen_supplement_entrypoint_if_exists(codegen_generator *gen,
             },
     };
     const u16 target_name_and_type_handle = jvm_constant_pool_push(
-        &class_file->constant_pool, &target_name_and_type, arena);
+        class_file, &target_name_and_type, arena);
     const Jvm_constant_pool_entry target_method_ref = {
         .kind = CONSTANT_POOL_KIND_METHOD_REF,
         .v.ref = {.class = class_file->this_class,
                   .name_and_type = target_name_and_type_handle}};
     const u16 target_method_ref_i = jvm_constant_pool_push(
-        &class_file->constant_pool, &target_method_ref, arena);
+        class_file, &target_method_ref, arena);
 
     const Method target_method_type = {
         .return_type_handle =
@@ -9142,14 +11449,14 @@ static void codegen_supplement_entrypoint_if_exists(codegen_generator *gen,
       const Type_handle source_argument_types_i = resolver_add_type(
           gen->resolver, &source_method_argument_types, arena);
       const u16 source_method_arg0_string = jvm_add_constant_cstring(
-          &class_file->constant_pool, "[Ljava/lang/String;", arena);
+          class_file, "[Ljava/lang/String;", arena);
 
       const Jvm_constant_pool_entry source_method_arg0_class = {
           .kind = CONSTANT_POOL_KIND_CLASS_INFO,
           .v.java_class_name = source_method_arg0_string,
       };
       const u16 source_method_arg0_class_i = jvm_constant_pool_push(
-          &class_file->constant_pool, &source_method_arg0_class, arena);
+          class_file, &source_method_arg0_class, arena);
 
       const Jvm_variable arg0 = {
           .type_handle = source_argument_types_i,
@@ -9178,7 +11485,7 @@ static void codegen_supplement_entrypoint_if_exists(codegen_generator *gen,
     Jvm_attribute attribute_code = {
         .kind = ATTRIBUTE_KIND_CODE,
         .name =
-            jvm_add_constant_cstring(&class_file->constant_pool, "Code", arena),
+            jvm_add_constant_cstring(class_file, "Code", arena),
         .v = {.code = code}};
     *array_push(&attributes, arena) = attribute_code;
   }
@@ -9190,13 +11497,242 @@ static void codegen_supplement_entrypoint_if_exists(codegen_generator *gen,
         .v = {.s = source_descriptor_str},
     };
     const u16 source_descriptor_i = jvm_constant_pool_push(
-        &class_file->constant_pool, &source_descriptor, arena);
+        class_file, &source_descriptor, arena);
     codegen_add_method(class_file, ACCESS_FLAGS_PUBLIC | ACCESS_FLAGS_STATIC,
                        target_method->name, source_descriptor_i, attributes,
                        arena);
   }
 }
 
+// Functions are generated in parallel, each with its own constant pool. The
+// constant pools are then merged in the order of the functions, which gives
+// the same class file as generating them one after the other.
+#define CODEGEN_WORKERS_MAX 32
+// Each worker carves memory out of the arena in chunks of at least this size,
+// whenever it runs out.
+#define CODEGEN_WORKER_MEMORY_MIN (1 * MiB)
+
+typedef struct {
+  Ast_handle ast_handle;
+  pg_pad(4);
+  Array(Jvm_constant_pool_entry) constant_pool;
+  Array(u32) constant_pool_relocations;
+  Jvm_method method;
+} Codegen_function;
+
+typedef struct {
+  Resolver *resolver;
+  Arena_source arena_source;
+  pthread_mutex_t lock; // Guards the types of `resolver`.
+  Codegen_function *functions;
+  u64 len;
+  u64 next; // Shared by all workers, atomically incremented.
+} Codegen_batch;
+
+typedef struct {
+  Codegen_batch *batch;
+  Arena arena;
+} Codegen_worker;
+
+static void *codegen_function_worker_run(void *arg) {
+  Codegen_worker *const worker = arg;
+  Codegen_batch *const batch = worker->batch;
+  Arena *const arena = &worker->arena;
+
+  for (;;) {
+    const u64 i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+    if (i >= batch->len)
+      break;
+
+    Codegen_function *const function = &batch->functions[i];
+
+    // Only the constant pool and the methods are used when generating a
+    // function.
+    Class_file class_file = {
+        .constant_pool = array_make(Jvm_constant_pool_entry, 0, 64, arena),
+        .methods = array_make(Jvm_method, 0, 1, arena),
+    };
+    codegen_generator gen = {
+        .resolver = batch->resolver,
+        .stack_map_frames = array_make(Stack_map_frame, 0, 16, arena),
+        .locals = array_make(Codegen_scope_variable, 0, 64, arena),
+        .constant_pool_relocations = array_make(u32, 0, 64, arena),
+        .line_numbers = array_make(Jvm_line_number_table_entry, 0, 16, arena),
+    };
+    codegen_emit_node(&gen, &class_file, function->ast_handle, arena);
+    pg_assert(class_file.methods.len == 1);
+
+    function->constant_pool = class_file.constant_pool;
+    function->constant_pool_relocations = gen.constant_pool_relocations;
+    function->method = class_file.methods.data[0];
+  }
+
+  return NULL;
+}
+
+static void
+codegen_remap_verification_info(Jvm_verification_info *verification_info,
+                                const u16 *remap) {
+  // Other kinds have no constant pool index.
+  if (verification_info->kind == VERIFICATION_INFO_OBJECT &&
+      verification_info->extra_data != 0)
+    verification_info->extra_data = remap[verification_info->extra_data];
+}
+
+static void codegen_remap_attribute(Jvm_attribute *attribute,
+                                    const Codegen_function *function,
+                                    const u16 *remap) {
+  attribute->name = remap[attribute->name];
+
+  switch (attribute->kind) {
+  case ATTRIBUTE_KIND_CODE: {
+    Jvm_attribute_code *const code = &attribute->v.code;
+
+    for (u64 i = 0; i < function->constant_pool_relocations.len; i++) {
+      u8 *const operand =
+          &code->bytecode.data[function->constant_pool_relocations.data[i]];
+      const u16 constant_i = (u16)((operand[0] << 8) | operand[1]);
+      const u16 constant_gen_i = remap[constant_i];
+      operand[0] = (u8)((constant_gen_i & 0xff00) >> 8);
+      operand[1] = (u8)(constant_gen_i & 0x00ff);
+    }
+
+    for (u64 i = 0; i < code->attributes.len; i++)
+      codegen_remap_attribute(&code->attributes.data[i], function, remap);
+    break;
+  }
+  case ATTRIBUTE_KIND_LINE_NUMBER_TABLE:
+    break; // Only the name, already remapped.
+  case ATTRIBUTE_KIND_STACK_MAP_TABLE: {
+    for (u64 i = 0; i < attribute->v.stack_map_table.len; i++) {
+      codegen_frame *const frame = attribute->v.stack_map_table.data[i].frame;
+
+      for (u64 j = 0; j < frame->locals.len; j++)
+        codegen_remap_verification_info(
+            &frame->locals.data[j].verification_info, remap);
+      for (u64 j = 0; j < frame->stack.len; j++)
+        codegen_remap_verification_info(&frame->stack.data[j], remap);
+    }
+    break;
+  }
+  default:
+    pg_assert(0 && "unreachable");
+  }
+}
+
+// Import the constant pool of the function in the one of the class file, and
+// remap all the constant pool indices of the method accordingly.
+static void codegen_merge_function(Class_file *class_file,
+                                   Codegen_function *function, Arena *arena) {
+  pg_assert(class_file != NULL);
+  pg_assert(function != NULL);
+
+  const Array(Jvm_constant_pool_entry) constant_pool = function->constant_pool;
+  u16 *const remap = arena_alloc(arena, sizeof(u16), _Alignof(u16),
+                                 (u64)constant_pool.len + 1);
+  for (u64 i = 0; i < constant_pool.len; i++) {
+    const Jvm_constant_pool_kind kind = constant_pool.data[i].kind;
+    remap[i + 1] = codegen_import_constant(class_file, constant_pool,
+                                           (u16)(i + 1), arena);
+
+    if (kind == CONSTANT_POOL_KIND_LONG || kind == CONSTANT_POOL_KIND_DOUBLE)
+      i += 1; // Skip the dummy.
+  }
+
+  Jvm_method method = function->method;
+  method.name = remap[method.name];
+  method.descriptor = remap[method.descriptor];
+  for (u64 i = 0; i < method.attributes.len; i++)
+    codegen_remap_attribute(&method.attributes.data[i], function, remap);
+
+  *array_push(&class_file->methods, arena) = method;
+}
+
+static void codegen_emit_functions(Resolver *resolver, Class_file *class_file,
+                                   codegen_generator *gen,
+                                   const Ast *root_node, Arena *arena) {
+  pg_assert(root_node->kind == AST_KIND_LIST);
+
+  Codegen_batch batch = {
+      .resolver = resolver,
+      .arena_source =
+          {
+              .arena = arena,
+              .lock = PTHREAD_MUTEX_INITIALIZER,
+              .chunk_size = CODEGEN_WORKER_MEMORY_MIN,
+          },
+      .lock = PTHREAD_MUTEX_INITIALIZER,
+      .functions =
+          arena_alloc(arena, sizeof(Codegen_function),
+                      _Alignof(Codegen_function), root_node->nodes.len),
+  };
+
+  for (u64 i = 0; i < root_node->nodes.len; i++) {
+    const Ast_handle ast_handle = root_node->nodes.data[i];
+    const Ast *const node = ast_handle_to_ptr(ast_handle, *arena);
+    if (node->kind == AST_KIND_FUNCTION_DEFINITION)
+      batch.functions[batch.len++].ast_handle = ast_handle;
+  }
+
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  u64 workers_count = cpus > 0 ? (u64)cpus : 1;
+  workers_count = pg_min(workers_count, CODEGEN_WORKERS_MAX);
+  workers_count = pg_min(workers_count, batch.len);
+
+  // Workers start with no memory and carve it out of the arena when needed.
+  Codegen_worker workers[CODEGEN_WORKERS_MAX] = {0};
+  for (u64 i = 0; i < workers_count; i++) {
+    workers[i] = (Codegen_worker){
+        .batch = &batch,
+        .arena = arena_slice(arena, 0),
+    };
+    workers[i].arena.source = &batch.arena_source;
+  }
+
+  if (workers_count > 1)
+    resolver->types_lock = &batch.lock;
+
+  pthread_t threads[CODEGEN_WORKERS_MAX] = {0};
+  bool threads_started[CODEGEN_WORKERS_MAX] = {0};
+  // The calling thread is the first worker.
+  for (u64 i = 1; i < workers_count; i++)
+    threads_started[i] = pthread_create(&threads[i], NULL,
+                                        codegen_function_worker_run,
+                                        &workers[i]) == 0;
+
+  if (workers_count > 0)
+    codegen_function_worker_run(&workers[0]);
+
+  for (u64 i = 0; i < workers_count; i++) {
+    if (!threads_started[i])
+      continue;
+
+    const int res = pthread_join(threads[i], NULL);
+    pg_assert(res == 0);
+  }
+  resolver->types_lock = NULL;
+
+  // Give back the unused memory of the last chunk, which is always the case
+  // with only one worker.
+  for (u64 i = 0; i < workers_count; i++) {
+    if (workers[i].arena.limit == arena->start)
+      arena->start = workers[i].arena.start;
+  }
+
+  // Merge in the order of the source, so that the output is deterministic.
+  u64 function_i = 0;
+  for (u64 i = 0; i < root_node->nodes.len; i++) {
+    const Ast_handle ast_handle = root_node->nodes.data[i];
+    const Ast *const node = ast_handle_to_ptr(ast_handle, *arena);
+
+    if (node->kind == AST_KIND_FUNCTION_DEFINITION)
+      codegen_merge_function(class_file, &batch.functions[function_i++], arena);
+    else
+      codegen_emit_node(gen, class_file, ast_handle, arena);
+  }
+  pg_assert(function_i == batch.len);
+}
+
 static void codegen_emit(Resolver *resolver, Class_file *class_file,
                          Ast_handle root_handle, Arena *arena) {
   pg_assert(resolver != NULL);
@@ -9211,7 +11747,12 @@ static void codegen_emit(Resolver *resolver, Class_file *class_file,
 
   codegen_emit_synthetic_class(&gen, class_file, arena);
 
-  codegen_emit_node(&gen, class_file, root_handle, arena);
+  if (!ast_handle_is_nil(root_handle) &&
+      ast_handle_to_ptr(root_handle, *arena)->kind == AST_KIND_LIST)
+    codegen_emit_functions(resolver, class_file, &gen,
+                           ast_handle_to_ptr(root_handle, *arena), arena);
+  else
+    codegen_emit_node(&gen, class_file, root_handle, arena);
 
   codegen_supplement_entrypoint_if_exists(&gen, class_file, arena);
 }
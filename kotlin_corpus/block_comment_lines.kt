@@ -0,0 +1,6 @@
+fun main() {
+  var a : Int = 1
+  /* Lines inside a delimited
+     comment still count. */
+  var a : Int = 2 // Reported at 5:7.
+}
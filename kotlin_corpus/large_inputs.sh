@@ -0,0 +1,49 @@
+#!/bin/sh
+# Compile many source files, then one large source file, which together are
+# bigger than the memory the parser would reserve if it sized each file from
+# an upper bound of its needs. Both must compile.
+#
+# Usage: ./kotlin_corpus/large_inputs.sh <compiler> <java_home> <class_path>
+set -eu
+
+compiler="$(realpath "$1")"
+java_home="$2"
+class_path="$3"
+
+dir="$(mktemp -d)"
+trap 'rm -rf "$dir"' EXIT
+cd "$dir"
+
+# A line comment of about 1 KB.
+padding="//$(printf '%01020d' 0)"
+
+# 200 files of 64 KB.
+i=0
+while [ "$i" -lt 200 ]; do
+  {
+    j=0
+    while [ "$j" -lt 64 ]; do
+      echo "$padding"
+      j=$((j + 1))
+    done
+    echo "fun f$i(): Int { return $i }"
+  } > "many_$i.kt"
+  i=$((i + 1))
+done
+echo 'fun main() { println(f0() + f199()) }' >> many_0.kt
+
+"$compiler" -j "$java_home" -c "$class_path" many_*.kt
+test "$(ls Many_*Kt.class | wc -l)" -eq 200
+
+# One file of 12 MB.
+{
+  i=0
+  while [ "$i" -lt 12288 ]; do
+    echo "$padding"
+    i=$((i + 1))
+  done
+  echo 'fun main() { println(1) }'
+} > large.kt
+
+"$compiler" -j "$java_home" -c "$class_path" large.kt
+test -f LargeKt.class
@@ -0,0 +1,203 @@
+fun f0(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f1(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f2(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f3(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f4(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f5(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f6(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f7(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f8(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f9(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f10(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f11(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f12(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f13(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f14(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f15(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f16(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f17(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f18(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f19(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f20(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f21(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f22(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f23(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f24(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f25(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f26(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f27(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f28(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f29(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f30(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f31(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f32(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f33(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f34(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f35(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f36(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f37(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f38(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f39(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f40(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f41(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f42(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f43(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f44(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f45(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f46(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f47(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f48(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f49(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f50(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f51(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f52(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f53(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f54(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f55(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f56(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f57(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f58(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f59(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f60(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f61(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f62(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f63(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f64(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f65(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f66(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f67(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f68(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f69(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f70(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f71(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f72(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f73(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f74(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f75(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f76(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f77(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f78(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f79(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f80(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f81(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f82(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f83(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f84(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f85(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f86(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f87(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f88(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f89(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f90(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f91(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f92(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f93(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f94(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f95(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f96(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f97(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f98(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun f99(a:Int):Int{if(a>1){return a+1}
+return a*2}
+fun main() {
+  println(f0(1))
+}
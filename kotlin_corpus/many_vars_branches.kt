@@ -0,0 +1,3002 @@
+fun main() {
+  var v0 : Int = 0
+  var v1 : Int = 1
+  var v2 : Int = 2
+  var v3 : Int = 3
+  var v4 : Int = 4
+  var v5 : Int = 5
+  var v6 : Int = 6
+  var v7 : Int = 7
+  var v8 : Int = 8
+  var v9 : Int = 9
+  var v10 : Int = 10
+  var v11 : Int = 11
+  var v12 : Int = 12
+  var v13 : Int = 13
+  var v14 : Int = 14
+  var v15 : Int = 15
+  var v16 : Int = 16
+  var v17 : Int = 17
+  var v18 : Int = 18
+  var v19 : Int = 19
+  var v20 : Int = 20
+  var v21 : Int = 21
+  var v22 : Int = 22
+  var v23 : Int = 23
+  var v24 : Int = 24
+  var v25 : Int = 25
+  var v26 : Int = 26
+  var v27 : Int = 27
+  var v28 : Int = 28
+  var v29 : Int = 29
+  var v30 : Int = 30
+  var v31 : Int = 31
+  var v32 : Int = 32
+  var v33 : Int = 33
+  var v34 : Int = 34
+  var v35 : Int = 35
+  var v36 : Int = 36
+  var v37 : Int = 37
+  var v38 : Int = 38
+  var v39 : Int = 39
+  var v40 : Int = 40
+  var v41 : Int = 41
+  var v42 : Int = 42
+  var v43 : Int = 43
+  var v44 : Int = 44
+  var v45 : Int = 45
+  var v46 : Int = 46
+  var v47 : Int = 47
+  var v48 : Int = 48
+  var v49 : Int = 49
+  var v50 : Int = 50
+  var v51 : Int = 51
+  var v52 : Int = 52
+  var v53 : Int = 53
+  var v54 : Int = 54
+  var v55 : Int = 55
+  var v56 : Int = 56
+  var v57 : Int = 57
+  var v58 : Int = 58
+  var v59 : Int = 59
+  var v60 : Int = 60
+  var v61 : Int = 61
+  var v62 : Int = 62
+  var v63 : Int = 63
+  var v64 : Int = 64
+  var v65 : Int = 65
+  var v66 : Int = 66
+  var v67 : Int = 67
+  var v68 : Int = 68
+  var v69 : Int = 69
+  var v70 : Int = 70
+  var v71 : Int = 71
+  var v72 : Int = 72
+  var v73 : Int = 73
+  var v74 : Int = 74
+  var v75 : Int = 75
+  var v76 : Int = 76
+  var v77 : Int = 77
+  var v78 : Int = 78
+  var v79 : Int = 79
+  var v80 : Int = 80
+  var v81 : Int = 81
+  var v82 : Int = 82
+  var v83 : Int = 83
+  var v84 : Int = 84
+  var v85 : Int = 85
+  var v86 : Int = 86
+  var v87 : Int = 87
+  var v88 : Int = 88
+  var v89 : Int = 89
+  var v90 : Int = 90
+  var v91 : Int = 91
+  var v92 : Int = 92
+  var v93 : Int = 93
+  var v94 : Int = 94
+  var v95 : Int = 95
+  var v96 : Int = 96
+  var v97 : Int = 97
+  var v98 : Int = 98
+  var v99 : Int = 99
+  var v100 : Int = 100
+  var v101 : Int = 101
+  var v102 : Int = 102
+  var v103 : Int = 103
+  var v104 : Int = 104
+  var v105 : Int = 105
+  var v106 : Int = 106
+  var v107 : Int = 107
+  var v108 : Int = 108
+  var v109 : Int = 109
+  var v110 : Int = 110
+  var v111 : Int = 111
+  var v112 : Int = 112
+  var v113 : Int = 113
+  var v114 : Int = 114
+  var v115 : Int = 115
+  var v116 : Int = 116
+  var v117 : Int = 117
+  var v118 : Int = 118
+  var v119 : Int = 119
+  var v120 : Int = 120
+  var v121 : Int = 121
+  var v122 : Int = 122
+  var v123 : Int = 123
+  var v124 : Int = 124
+  var v125 : Int = 125
+  var v126 : Int = 126
+  var v127 : Int = 127
+  var v128 : Int = 128
+  var v129 : Int = 129
+  var v130 : Int = 130
+  var v131 : Int = 131
+  var v132 : Int = 132
+  var v133 : Int = 133
+  var v134 : Int = 134
+  var v135 : Int = 135
+  var v136 : Int = 136
+  var v137 : Int = 137
+  var v138 : Int = 138
+  var v139 : Int = 139
+  var v140 : Int = 140
+  var v141 : Int = 141
+  var v142 : Int = 142
+  var v143 : Int = 143
+  var v144 : Int = 144
+  var v145 : Int = 145
+  var v146 : Int = 146
+  var v147 : Int = 147
+  var v148 : Int = 148
+  var v149 : Int = 149
+  var v150 : Int = 150
+  var v151 : Int = 151
+  var v152 : Int = 152
+  var v153 : Int = 153
+  var v154 : Int = 154
+  var v155 : Int = 155
+  var v156 : Int = 156
+  var v157 : Int = 157
+  var v158 : Int = 158
+  var v159 : Int = 159
+  var v160 : Int = 160
+  var v161 : Int = 161
+  var v162 : Int = 162
+  var v163 : Int = 163
+  var v164 : Int = 164
+  var v165 : Int = 165
+  var v166 : Int = 166
+  var v167 : Int = 167
+  var v168 : Int = 168
+  var v169 : Int = 169
+  var v170 : Int = 170
+  var v171 : Int = 171
+  var v172 : Int = 172
+  var v173 : Int = 173
+  var v174 : Int = 174
+  var v175 : Int = 175
+  var v176 : Int = 176
+  var v177 : Int = 177
+  var v178 : Int = 178
+  var v179 : Int = 179
+  var v180 : Int = 180
+  var v181 : Int = 181
+  var v182 : Int = 182
+  var v183 : Int = 183
+  var v184 : Int = 184
+  var v185 : Int = 185
+  var v186 : Int = 186
+  var v187 : Int = 187
+  var v188 : Int = 188
+  var v189 : Int = 189
+  var v190 : Int = 190
+  var v191 : Int = 191
+  var v192 : Int = 192
+  var v193 : Int = 193
+  var v194 : Int = 194
+  var v195 : Int = 195
+  var v196 : Int = 196
+  var v197 : Int = 197
+  var v198 : Int = 198
+  var v199 : Int = 199
+  var v200 : Int = 200
+  var v201 : Int = 201
+  var v202 : Int = 202
+  var v203 : Int = 203
+  var v204 : Int = 204
+  var v205 : Int = 205
+  var v206 : Int = 206
+  var v207 : Int = 207
+  var v208 : Int = 208
+  var v209 : Int = 209
+  var v210 : Int = 210
+  var v211 : Int = 211
+  var v212 : Int = 212
+  var v213 : Int = 213
+  var v214 : Int = 214
+  var v215 : Int = 215
+  var v216 : Int = 216
+  var v217 : Int = 217
+  var v218 : Int = 218
+  var v219 : Int = 219
+  var v220 : Int = 220
+  var v221 : Int = 221
+  var v222 : Int = 222
+  var v223 : Int = 223
+  var v224 : Int = 224
+  var v225 : Int = 225
+  var v226 : Int = 226
+  var v227 : Int = 227
+  var v228 : Int = 228
+  var v229 : Int = 229
+  var v230 : Int = 230
+  var v231 : Int = 231
+  var v232 : Int = 232
+  var v233 : Int = 233
+  var v234 : Int = 234
+  var v235 : Int = 235
+  var v236 : Int = 236
+  var v237 : Int = 237
+  var v238 : Int = 238
+  var v239 : Int = 239
+  var v240 : Int = 240
+  var v241 : Int = 241
+  var v242 : Int = 242
+  var v243 : Int = 243
+  var v244 : Int = 244
+  var v245 : Int = 245
+  var v246 : Int = 246
+  var v247 : Int = 247
+  var v248 : Int = 248
+  var v249 : Int = 249
+  var v250 : Int = 250
+  var v251 : Int = 251
+  var v252 : Int = 252
+  var v253 : Int = 253
+  var v254 : Int = 254
+  var v255 : Int = 255
+  var v256 : Int = 256
+  var v257 : Int = 257
+  var v258 : Int = 258
+  var v259 : Int = 259
+  var v260 : Int = 260
+  var v261 : Int = 261
+  var v262 : Int = 262
+  var v263 : Int = 263
+  var v264 : Int = 264
+  var v265 : Int = 265
+  var v266 : Int = 266
+  var v267 : Int = 267
+  var v268 : Int = 268
+  var v269 : Int = 269
+  var v270 : Int = 270
+  var v271 : Int = 271
+  var v272 : Int = 272
+  var v273 : Int = 273
+  var v274 : Int = 274
+  var v275 : Int = 275
+  var v276 : Int = 276
+  var v277 : Int = 277
+  var v278 : Int = 278
+  var v279 : Int = 279
+  var v280 : Int = 280
+  var v281 : Int = 281
+  var v282 : Int = 282
+  var v283 : Int = 283
+  var v284 : Int = 284
+  var v285 : Int = 285
+  var v286 : Int = 286
+  var v287 : Int = 287
+  var v288 : Int = 288
+  var v289 : Int = 289
+  var v290 : Int = 290
+  var v291 : Int = 291
+  var v292 : Int = 292
+  var v293 : Int = 293
+  var v294 : Int = 294
+  var v295 : Int = 295
+  var v296 : Int = 296
+  var v297 : Int = 297
+  var v298 : Int = 298
+  var v299 : Int = 299
+  var v300 : Int = 300
+  var v301 : Int = 301
+  var v302 : Int = 302
+  var v303 : Int = 303
+  var v304 : Int = 304
+  var v305 : Int = 305
+  var v306 : Int = 306
+  var v307 : Int = 307
+  var v308 : Int = 308
+  var v309 : Int = 309
+  var v310 : Int = 310
+  var v311 : Int = 311
+  var v312 : Int = 312
+  var v313 : Int = 313
+  var v314 : Int = 314
+  var v315 : Int = 315
+  var v316 : Int = 316
+  var v317 : Int = 317
+  var v318 : Int = 318
+  var v319 : Int = 319
+  var v320 : Int = 320
+  var v321 : Int = 321
+  var v322 : Int = 322
+  var v323 : Int = 323
+  var v324 : Int = 324
+  var v325 : Int = 325
+  var v326 : Int = 326
+  var v327 : Int = 327
+  var v328 : Int = 328
+  var v329 : Int = 329
+  var v330 : Int = 330
+  var v331 : Int = 331
+  var v332 : Int = 332
+  var v333 : Int = 333
+  var v334 : Int = 334
+  var v335 : Int = 335
+  var v336 : Int = 336
+  var v337 : Int = 337
+  var v338 : Int = 338
+  var v339 : Int = 339
+  var v340 : Int = 340
+  var v341 : Int = 341
+  var v342 : Int = 342
+  var v343 : Int = 343
+  var v344 : Int = 344
+  var v345 : Int = 345
+  var v346 : Int = 346
+  var v347 : Int = 347
+  var v348 : Int = 348
+  var v349 : Int = 349
+  var v350 : Int = 350
+  var v351 : Int = 351
+  var v352 : Int = 352
+  var v353 : Int = 353
+  var v354 : Int = 354
+  var v355 : Int = 355
+  var v356 : Int = 356
+  var v357 : Int = 357
+  var v358 : Int = 358
+  var v359 : Int = 359
+  var v360 : Int = 360
+  var v361 : Int = 361
+  var v362 : Int = 362
+  var v363 : Int = 363
+  var v364 : Int = 364
+  var v365 : Int = 365
+  var v366 : Int = 366
+  var v367 : Int = 367
+  var v368 : Int = 368
+  var v369 : Int = 369
+  var v370 : Int = 370
+  var v371 : Int = 371
+  var v372 : Int = 372
+  var v373 : Int = 373
+  var v374 : Int = 374
+  var v375 : Int = 375
+  var v376 : Int = 376
+  var v377 : Int = 377
+  var v378 : Int = 378
+  var v379 : Int = 379
+  var v380 : Int = 380
+  var v381 : Int = 381
+  var v382 : Int = 382
+  var v383 : Int = 383
+  var v384 : Int = 384
+  var v385 : Int = 385
+  var v386 : Int = 386
+  var v387 : Int = 387
+  var v388 : Int = 388
+  var v389 : Int = 389
+  var v390 : Int = 390
+  var v391 : Int = 391
+  var v392 : Int = 392
+  var v393 : Int = 393
+  var v394 : Int = 394
+  var v395 : Int = 395
+  var v396 : Int = 396
+  var v397 : Int = 397
+  var v398 : Int = 398
+  var v399 : Int = 399
+  var v400 : Int = 400
+  var v401 : Int = 401
+  var v402 : Int = 402
+  var v403 : Int = 403
+  var v404 : Int = 404
+  var v405 : Int = 405
+  var v406 : Int = 406
+  var v407 : Int = 407
+  var v408 : Int = 408
+  var v409 : Int = 409
+  var v410 : Int = 410
+  var v411 : Int = 411
+  var v412 : Int = 412
+  var v413 : Int = 413
+  var v414 : Int = 414
+  var v415 : Int = 415
+  var v416 : Int = 416
+  var v417 : Int = 417
+  var v418 : Int = 418
+  var v419 : Int = 419
+  var v420 : Int = 420
+  var v421 : Int = 421
+  var v422 : Int = 422
+  var v423 : Int = 423
+  var v424 : Int = 424
+  var v425 : Int = 425
+  var v426 : Int = 426
+  var v427 : Int = 427
+  var v428 : Int = 428
+  var v429 : Int = 429
+  var v430 : Int = 430
+  var v431 : Int = 431
+  var v432 : Int = 432
+  var v433 : Int = 433
+  var v434 : Int = 434
+  var v435 : Int = 435
+  var v436 : Int = 436
+  var v437 : Int = 437
+  var v438 : Int = 438
+  var v439 : Int = 439
+  var v440 : Int = 440
+  var v441 : Int = 441
+  var v442 : Int = 442
+  var v443 : Int = 443
+  var v444 : Int = 444
+  var v445 : Int = 445
+  var v446 : Int = 446
+  var v447 : Int = 447
+  var v448 : Int = 448
+  var v449 : Int = 449
+  var v450 : Int = 450
+  var v451 : Int = 451
+  var v452 : Int = 452
+  var v453 : Int = 453
+  var v454 : Int = 454
+  var v455 : Int = 455
+  var v456 : Int = 456
+  var v457 : Int = 457
+  var v458 : Int = 458
+  var v459 : Int = 459
+  var v460 : Int = 460
+  var v461 : Int = 461
+  var v462 : Int = 462
+  var v463 : Int = 463
+  var v464 : Int = 464
+  var v465 : Int = 465
+  var v466 : Int = 466
+  var v467 : Int = 467
+  var v468 : Int = 468
+  var v469 : Int = 469
+  var v470 : Int = 470
+  var v471 : Int = 471
+  var v472 : Int = 472
+  var v473 : Int = 473
+  var v474 : Int = 474
+  var v475 : Int = 475
+  var v476 : Int = 476
+  var v477 : Int = 477
+  var v478 : Int = 478
+  var v479 : Int = 479
+  var v480 : Int = 480
+  var v481 : Int = 481
+  var v482 : Int = 482
+  var v483 : Int = 483
+  var v484 : Int = 484
+  var v485 : Int = 485
+  var v486 : Int = 486
+  var v487 : Int = 487
+  var v488 : Int = 488
+  var v489 : Int = 489
+  var v490 : Int = 490
+  var v491 : Int = 491
+  var v492 : Int = 492
+  var v493 : Int = 493
+  var v494 : Int = 494
+  var v495 : Int = 495
+  var v496 : Int = 496
+  var v497 : Int = 497
+  var v498 : Int = 498
+  var v499 : Int = 499
+  if (v0 > 1) {
+    println(v0)
+  } else {
+    println(0)
+  }
+  if (v1 > 1) {
+    println(v1)
+  } else {
+    println(0)
+  }
+  if (v2 > 1) {
+    println(v2)
+  } else {
+    println(0)
+  }
+  if (v3 > 1) {
+    println(v3)
+  } else {
+    println(0)
+  }
+  if (v4 > 1) {
+    println(v4)
+  } else {
+    println(0)
+  }
+  if (v5 > 1) {
+    println(v5)
+  } else {
+    println(0)
+  }
+  if (v6 > 1) {
+    println(v6)
+  } else {
+    println(0)
+  }
+  if (v7 > 1) {
+    println(v7)
+  } else {
+    println(0)
+  }
+  if (v8 > 1) {
+    println(v8)
+  } else {
+    println(0)
+  }
+  if (v9 > 1) {
+    println(v9)
+  } else {
+    println(0)
+  }
+  if (v10 > 1) {
+    println(v10)
+  } else {
+    println(0)
+  }
+  if (v11 > 1) {
+    println(v11)
+  } else {
+    println(0)
+  }
+  if (v12 > 1) {
+    println(v12)
+  } else {
+    println(0)
+  }
+  if (v13 > 1) {
+    println(v13)
+  } else {
+    println(0)
+  }
+  if (v14 > 1) {
+    println(v14)
+  } else {
+    println(0)
+  }
+  if (v15 > 1) {
+    println(v15)
+  } else {
+    println(0)
+  }
+  if (v16 > 1) {
+    println(v16)
+  } else {
+    println(0)
+  }
+  if (v17 > 1) {
+    println(v17)
+  } else {
+    println(0)
+  }
+  if (v18 > 1) {
+    println(v18)
+  } else {
+    println(0)
+  }
+  if (v19 > 1) {
+    println(v19)
+  } else {
+    println(0)
+  }
+  if (v20 > 1) {
+    println(v20)
+  } else {
+    println(0)
+  }
+  if (v21 > 1) {
+    println(v21)
+  } else {
+    println(0)
+  }
+  if (v22 > 1) {
+    println(v22)
+  } else {
+    println(0)
+  }
+  if (v23 > 1) {
+    println(v23)
+  } else {
+    println(0)
+  }
+  if (v24 > 1) {
+    println(v24)
+  } else {
+    println(0)
+  }
+  if (v25 > 1) {
+    println(v25)
+  } else {
+    println(0)
+  }
+  if (v26 > 1) {
+    println(v26)
+  } else {
+    println(0)
+  }
+  if (v27 > 1) {
+    println(v27)
+  } else {
+    println(0)
+  }
+  if (v28 > 1) {
+    println(v28)
+  } else {
+    println(0)
+  }
+  if (v29 > 1) {
+    println(v29)
+  } else {
+    println(0)
+  }
+  if (v30 > 1) {
+    println(v30)
+  } else {
+    println(0)
+  }
+  if (v31 > 1) {
+    println(v31)
+  } else {
+    println(0)
+  }
+  if (v32 > 1) {
+    println(v32)
+  } else {
+    println(0)
+  }
+  if (v33 > 1) {
+    println(v33)
+  } else {
+    println(0)
+  }
+  if (v34 > 1) {
+    println(v34)
+  } else {
+    println(0)
+  }
+  if (v35 > 1) {
+    println(v35)
+  } else {
+    println(0)
+  }
+  if (v36 > 1) {
+    println(v36)
+  } else {
+    println(0)
+  }
+  if (v37 > 1) {
+    println(v37)
+  } else {
+    println(0)
+  }
+  if (v38 > 1) {
+    println(v38)
+  } else {
+    println(0)
+  }
+  if (v39 > 1) {
+    println(v39)
+  } else {
+    println(0)
+  }
+  if (v40 > 1) {
+    println(v40)
+  } else {
+    println(0)
+  }
+  if (v41 > 1) {
+    println(v41)
+  } else {
+    println(0)
+  }
+  if (v42 > 1) {
+    println(v42)
+  } else {
+    println(0)
+  }
+  if (v43 > 1) {
+    println(v43)
+  } else {
+    println(0)
+  }
+  if (v44 > 1) {
+    println(v44)
+  } else {
+    println(0)
+  }
+  if (v45 > 1) {
+    println(v45)
+  } else {
+    println(0)
+  }
+  if (v46 > 1) {
+    println(v46)
+  } else {
+    println(0)
+  }
+  if (v47 > 1) {
+    println(v47)
+  } else {
+    println(0)
+  }
+  if (v48 > 1) {
+    println(v48)
+  } else {
+    println(0)
+  }
+  if (v49 > 1) {
+    println(v49)
+  } else {
+    println(0)
+  }
+  if (v50 > 1) {
+    println(v50)
+  } else {
+    println(0)
+  }
+  if (v51 > 1) {
+    println(v51)
+  } else {
+    println(0)
+  }
+  if (v52 > 1) {
+    println(v52)
+  } else {
+    println(0)
+  }
+  if (v53 > 1) {
+    println(v53)
+  } else {
+    println(0)
+  }
+  if (v54 > 1) {
+    println(v54)
+  } else {
+    println(0)
+  }
+  if (v55 > 1) {
+    println(v55)
+  } else {
+    println(0)
+  }
+  if (v56 > 1) {
+    println(v56)
+  } else {
+    println(0)
+  }
+  if (v57 > 1) {
+    println(v57)
+  } else {
+    println(0)
+  }
+  if (v58 > 1) {
+    println(v58)
+  } else {
+    println(0)
+  }
+  if (v59 > 1) {
+    println(v59)
+  } else {
+    println(0)
+  }
+  if (v60 > 1) {
+    println(v60)
+  } else {
+    println(0)
+  }
+  if (v61 > 1) {
+    println(v61)
+  } else {
+    println(0)
+  }
+  if (v62 > 1) {
+    println(v62)
+  } else {
+    println(0)
+  }
+  if (v63 > 1) {
+    println(v63)
+  } else {
+    println(0)
+  }
+  if (v64 > 1) {
+    println(v64)
+  } else {
+    println(0)
+  }
+  if (v65 > 1) {
+    println(v65)
+  } else {
+    println(0)
+  }
+  if (v66 > 1) {
+    println(v66)
+  } else {
+    println(0)
+  }
+  if (v67 > 1) {
+    println(v67)
+  } else {
+    println(0)
+  }
+  if (v68 > 1) {
+    println(v68)
+  } else {
+    println(0)
+  }
+  if (v69 > 1) {
+    println(v69)
+  } else {
+    println(0)
+  }
+  if (v70 > 1) {
+    println(v70)
+  } else {
+    println(0)
+  }
+  if (v71 > 1) {
+    println(v71)
+  } else {
+    println(0)
+  }
+  if (v72 > 1) {
+    println(v72)
+  } else {
+    println(0)
+  }
+  if (v73 > 1) {
+    println(v73)
+  } else {
+    println(0)
+  }
+  if (v74 > 1) {
+    println(v74)
+  } else {
+    println(0)
+  }
+  if (v75 > 1) {
+    println(v75)
+  } else {
+    println(0)
+  }
+  if (v76 > 1) {
+    println(v76)
+  } else {
+    println(0)
+  }
+  if (v77 > 1) {
+    println(v77)
+  } else {
+    println(0)
+  }
+  if (v78 > 1) {
+    println(v78)
+  } else {
+    println(0)
+  }
+  if (v79 > 1) {
+    println(v79)
+  } else {
+    println(0)
+  }
+  if (v80 > 1) {
+    println(v80)
+  } else {
+    println(0)
+  }
+  if (v81 > 1) {
+    println(v81)
+  } else {
+    println(0)
+  }
+  if (v82 > 1) {
+    println(v82)
+  } else {
+    println(0)
+  }
+  if (v83 > 1) {
+    println(v83)
+  } else {
+    println(0)
+  }
+  if (v84 > 1) {
+    println(v84)
+  } else {
+    println(0)
+  }
+  if (v85 > 1) {
+    println(v85)
+  } else {
+    println(0)
+  }
+  if (v86 > 1) {
+    println(v86)
+  } else {
+    println(0)
+  }
+  if (v87 > 1) {
+    println(v87)
+  } else {
+    println(0)
+  }
+  if (v88 > 1) {
+    println(v88)
+  } else {
+    println(0)
+  }
+  if (v89 > 1) {
+    println(v89)
+  } else {
+    println(0)
+  }
+  if (v90 > 1) {
+    println(v90)
+  } else {
+    println(0)
+  }
+  if (v91 > 1) {
+    println(v91)
+  } else {
+    println(0)
+  }
+  if (v92 > 1) {
+    println(v92)
+  } else {
+    println(0)
+  }
+  if (v93 > 1) {
+    println(v93)
+  } else {
+    println(0)
+  }
+  if (v94 > 1) {
+    println(v94)
+  } else {
+    println(0)
+  }
+  if (v95 > 1) {
+    println(v95)
+  } else {
+    println(0)
+  }
+  if (v96 > 1) {
+    println(v96)
+  } else {
+    println(0)
+  }
+  if (v97 > 1) {
+    println(v97)
+  } else {
+    println(0)
+  }
+  if (v98 > 1) {
+    println(v98)
+  } else {
+    println(0)
+  }
+  if (v99 > 1) {
+    println(v99)
+  } else {
+    println(0)
+  }
+  if (v100 > 1) {
+    println(v100)
+  } else {
+    println(0)
+  }
+  if (v101 > 1) {
+    println(v101)
+  } else {
+    println(0)
+  }
+  if (v102 > 1) {
+    println(v102)
+  } else {
+    println(0)
+  }
+  if (v103 > 1) {
+    println(v103)
+  } else {
+    println(0)
+  }
+  if (v104 > 1) {
+    println(v104)
+  } else {
+    println(0)
+  }
+  if (v105 > 1) {
+    println(v105)
+  } else {
+    println(0)
+  }
+  if (v106 > 1) {
+    println(v106)
+  } else {
+    println(0)
+  }
+  if (v107 > 1) {
+    println(v107)
+  } else {
+    println(0)
+  }
+  if (v108 > 1) {
+    println(v108)
+  } else {
+    println(0)
+  }
+  if (v109 > 1) {
+    println(v109)
+  } else {
+    println(0)
+  }
+  if (v110 > 1) {
+    println(v110)
+  } else {
+    println(0)
+  }
+  if (v111 > 1) {
+    println(v111)
+  } else {
+    println(0)
+  }
+  if (v112 > 1) {
+    println(v112)
+  } else {
+    println(0)
+  }
+  if (v113 > 1) {
+    println(v113)
+  } else {
+    println(0)
+  }
+  if (v114 > 1) {
+    println(v114)
+  } else {
+    println(0)
+  }
+  if (v115 > 1) {
+    println(v115)
+  } else {
+    println(0)
+  }
+  if (v116 > 1) {
+    println(v116)
+  } else {
+    println(0)
+  }
+  if (v117 > 1) {
+    println(v117)
+  } else {
+    println(0)
+  }
+  if (v118 > 1) {
+    println(v118)
+  } else {
+    println(0)
+  }
+  if (v119 > 1) {
+    println(v119)
+  } else {
+    println(0)
+  }
+  if (v120 > 1) {
+    println(v120)
+  } else {
+    println(0)
+  }
+  if (v121 > 1) {
+    println(v121)
+  } else {
+    println(0)
+  }
+  if (v122 > 1) {
+    println(v122)
+  } else {
+    println(0)
+  }
+  if (v123 > 1) {
+    println(v123)
+  } else {
+    println(0)
+  }
+  if (v124 > 1) {
+    println(v124)
+  } else {
+    println(0)
+  }
+  if (v125 > 1) {
+    println(v125)
+  } else {
+    println(0)
+  }
+  if (v126 > 1) {
+    println(v126)
+  } else {
+    println(0)
+  }
+  if (v127 > 1) {
+    println(v127)
+  } else {
+    println(0)
+  }
+  if (v128 > 1) {
+    println(v128)
+  } else {
+    println(0)
+  }
+  if (v129 > 1) {
+    println(v129)
+  } else {
+    println(0)
+  }
+  if (v130 > 1) {
+    println(v130)
+  } else {
+    println(0)
+  }
+  if (v131 > 1) {
+    println(v131)
+  } else {
+    println(0)
+  }
+  if (v132 > 1) {
+    println(v132)
+  } else {
+    println(0)
+  }
+  if (v133 > 1) {
+    println(v133)
+  } else {
+    println(0)
+  }
+  if (v134 > 1) {
+    println(v134)
+  } else {
+    println(0)
+  }
+  if (v135 > 1) {
+    println(v135)
+  } else {
+    println(0)
+  }
+  if (v136 > 1) {
+    println(v136)
+  } else {
+    println(0)
+  }
+  if (v137 > 1) {
+    println(v137)
+  } else {
+    println(0)
+  }
+  if (v138 > 1) {
+    println(v138)
+  } else {
+    println(0)
+  }
+  if (v139 > 1) {
+    println(v139)
+  } else {
+    println(0)
+  }
+  if (v140 > 1) {
+    println(v140)
+  } else {
+    println(0)
+  }
+  if (v141 > 1) {
+    println(v141)
+  } else {
+    println(0)
+  }
+  if (v142 > 1) {
+    println(v142)
+  } else {
+    println(0)
+  }
+  if (v143 > 1) {
+    println(v143)
+  } else {
+    println(0)
+  }
+  if (v144 > 1) {
+    println(v144)
+  } else {
+    println(0)
+  }
+  if (v145 > 1) {
+    println(v145)
+  } else {
+    println(0)
+  }
+  if (v146 > 1) {
+    println(v146)
+  } else {
+    println(0)
+  }
+  if (v147 > 1) {
+    println(v147)
+  } else {
+    println(0)
+  }
+  if (v148 > 1) {
+    println(v148)
+  } else {
+    println(0)
+  }
+  if (v149 > 1) {
+    println(v149)
+  } else {
+    println(0)
+  }
+  if (v150 > 1) {
+    println(v150)
+  } else {
+    println(0)
+  }
+  if (v151 > 1) {
+    println(v151)
+  } else {
+    println(0)
+  }
+  if (v152 > 1) {
+    println(v152)
+  } else {
+    println(0)
+  }
+  if (v153 > 1) {
+    println(v153)
+  } else {
+    println(0)
+  }
+  if (v154 > 1) {
+    println(v154)
+  } else {
+    println(0)
+  }
+  if (v155 > 1) {
+    println(v155)
+  } else {
+    println(0)
+  }
+  if (v156 > 1) {
+    println(v156)
+  } else {
+    println(0)
+  }
+  if (v157 > 1) {
+    println(v157)
+  } else {
+    println(0)
+  }
+  if (v158 > 1) {
+    println(v158)
+  } else {
+    println(0)
+  }
+  if (v159 > 1) {
+    println(v159)
+  } else {
+    println(0)
+  }
+  if (v160 > 1) {
+    println(v160)
+  } else {
+    println(0)
+  }
+  if (v161 > 1) {
+    println(v161)
+  } else {
+    println(0)
+  }
+  if (v162 > 1) {
+    println(v162)
+  } else {
+    println(0)
+  }
+  if (v163 > 1) {
+    println(v163)
+  } else {
+    println(0)
+  }
+  if (v164 > 1) {
+    println(v164)
+  } else {
+    println(0)
+  }
+  if (v165 > 1) {
+    println(v165)
+  } else {
+    println(0)
+  }
+  if (v166 > 1) {
+    println(v166)
+  } else {
+    println(0)
+  }
+  if (v167 > 1) {
+    println(v167)
+  } else {
+    println(0)
+  }
+  if (v168 > 1) {
+    println(v168)
+  } else {
+    println(0)
+  }
+  if (v169 > 1) {
+    println(v169)
+  } else {
+    println(0)
+  }
+  if (v170 > 1) {
+    println(v170)
+  } else {
+    println(0)
+  }
+  if (v171 > 1) {
+    println(v171)
+  } else {
+    println(0)
+  }
+  if (v172 > 1) {
+    println(v172)
+  } else {
+    println(0)
+  }
+  if (v173 > 1) {
+    println(v173)
+  } else {
+    println(0)
+  }
+  if (v174 > 1) {
+    println(v174)
+  } else {
+    println(0)
+  }
+  if (v175 > 1) {
+    println(v175)
+  } else {
+    println(0)
+  }
+  if (v176 > 1) {
+    println(v176)
+  } else {
+    println(0)
+  }
+  if (v177 > 1) {
+    println(v177)
+  } else {
+    println(0)
+  }
+  if (v178 > 1) {
+    println(v178)
+  } else {
+    println(0)
+  }
+  if (v179 > 1) {
+    println(v179)
+  } else {
+    println(0)
+  }
+  if (v180 > 1) {
+    println(v180)
+  } else {
+    println(0)
+  }
+  if (v181 > 1) {
+    println(v181)
+  } else {
+    println(0)
+  }
+  if (v182 > 1) {
+    println(v182)
+  } else {
+    println(0)
+  }
+  if (v183 > 1) {
+    println(v183)
+  } else {
+    println(0)
+  }
+  if (v184 > 1) {
+    println(v184)
+  } else {
+    println(0)
+  }
+  if (v185 > 1) {
+    println(v185)
+  } else {
+    println(0)
+  }
+  if (v186 > 1) {
+    println(v186)
+  } else {
+    println(0)
+  }
+  if (v187 > 1) {
+    println(v187)
+  } else {
+    println(0)
+  }
+  if (v188 > 1) {
+    println(v188)
+  } else {
+    println(0)
+  }
+  if (v189 > 1) {
+    println(v189)
+  } else {
+    println(0)
+  }
+  if (v190 > 1) {
+    println(v190)
+  } else {
+    println(0)
+  }
+  if (v191 > 1) {
+    println(v191)
+  } else {
+    println(0)
+  }
+  if (v192 > 1) {
+    println(v192)
+  } else {
+    println(0)
+  }
+  if (v193 > 1) {
+    println(v193)
+  } else {
+    println(0)
+  }
+  if (v194 > 1) {
+    println(v194)
+  } else {
+    println(0)
+  }
+  if (v195 > 1) {
+    println(v195)
+  } else {
+    println(0)
+  }
+  if (v196 > 1) {
+    println(v196)
+  } else {
+    println(0)
+  }
+  if (v197 > 1) {
+    println(v197)
+  } else {
+    println(0)
+  }
+  if (v198 > 1) {
+    println(v198)
+  } else {
+    println(0)
+  }
+  if (v199 > 1) {
+    println(v199)
+  } else {
+    println(0)
+  }
+  if (v200 > 1) {
+    println(v200)
+  } else {
+    println(0)
+  }
+  if (v201 > 1) {
+    println(v201)
+  } else {
+    println(0)
+  }
+  if (v202 > 1) {
+    println(v202)
+  } else {
+    println(0)
+  }
+  if (v203 > 1) {
+    println(v203)
+  } else {
+    println(0)
+  }
+  if (v204 > 1) {
+    println(v204)
+  } else {
+    println(0)
+  }
+  if (v205 > 1) {
+    println(v205)
+  } else {
+    println(0)
+  }
+  if (v206 > 1) {
+    println(v206)
+  } else {
+    println(0)
+  }
+  if (v207 > 1) {
+    println(v207)
+  } else {
+    println(0)
+  }
+  if (v208 > 1) {
+    println(v208)
+  } else {
+    println(0)
+  }
+  if (v209 > 1) {
+    println(v209)
+  } else {
+    println(0)
+  }
+  if (v210 > 1) {
+    println(v210)
+  } else {
+    println(0)
+  }
+  if (v211 > 1) {
+    println(v211)
+  } else {
+    println(0)
+  }
+  if (v212 > 1) {
+    println(v212)
+  } else {
+    println(0)
+  }
+  if (v213 > 1) {
+    println(v213)
+  } else {
+    println(0)
+  }
+  if (v214 > 1) {
+    println(v214)
+  } else {
+    println(0)
+  }
+  if (v215 > 1) {
+    println(v215)
+  } else {
+    println(0)
+  }
+  if (v216 > 1) {
+    println(v216)
+  } else {
+    println(0)
+  }
+  if (v217 > 1) {
+    println(v217)
+  } else {
+    println(0)
+  }
+  if (v218 > 1) {
+    println(v218)
+  } else {
+    println(0)
+  }
+  if (v219 > 1) {
+    println(v219)
+  } else {
+    println(0)
+  }
+  if (v220 > 1) {
+    println(v220)
+  } else {
+    println(0)
+  }
+  if (v221 > 1) {
+    println(v221)
+  } else {
+    println(0)
+  }
+  if (v222 > 1) {
+    println(v222)
+  } else {
+    println(0)
+  }
+  if (v223 > 1) {
+    println(v223)
+  } else {
+    println(0)
+  }
+  if (v224 > 1) {
+    println(v224)
+  } else {
+    println(0)
+  }
+  if (v225 > 1) {
+    println(v225)
+  } else {
+    println(0)
+  }
+  if (v226 > 1) {
+    println(v226)
+  } else {
+    println(0)
+  }
+  if (v227 > 1) {
+    println(v227)
+  } else {
+    println(0)
+  }
+  if (v228 > 1) {
+    println(v228)
+  } else {
+    println(0)
+  }
+  if (v229 > 1) {
+    println(v229)
+  } else {
+    println(0)
+  }
+  if (v230 > 1) {
+    println(v230)
+  } else {
+    println(0)
+  }
+  if (v231 > 1) {
+    println(v231)
+  } else {
+    println(0)
+  }
+  if (v232 > 1) {
+    println(v232)
+  } else {
+    println(0)
+  }
+  if (v233 > 1) {
+    println(v233)
+  } else {
+    println(0)
+  }
+  if (v234 > 1) {
+    println(v234)
+  } else {
+    println(0)
+  }
+  if (v235 > 1) {
+    println(v235)
+  } else {
+    println(0)
+  }
+  if (v236 > 1) {
+    println(v236)
+  } else {
+    println(0)
+  }
+  if (v237 > 1) {
+    println(v237)
+  } else {
+    println(0)
+  }
+  if (v238 > 1) {
+    println(v238)
+  } else {
+    println(0)
+  }
+  if (v239 > 1) {
+    println(v239)
+  } else {
+    println(0)
+  }
+  if (v240 > 1) {
+    println(v240)
+  } else {
+    println(0)
+  }
+  if (v241 > 1) {
+    println(v241)
+  } else {
+    println(0)
+  }
+  if (v242 > 1) {
+    println(v242)
+  } else {
+    println(0)
+  }
+  if (v243 > 1) {
+    println(v243)
+  } else {
+    println(0)
+  }
+  if (v244 > 1) {
+    println(v244)
+  } else {
+    println(0)
+  }
+  if (v245 > 1) {
+    println(v245)
+  } else {
+    println(0)
+  }
+  if (v246 > 1) {
+    println(v246)
+  } else {
+    println(0)
+  }
+  if (v247 > 1) {
+    println(v247)
+  } else {
+    println(0)
+  }
+  if (v248 > 1) {
+    println(v248)
+  } else {
+    println(0)
+  }
+  if (v249 > 1) {
+    println(v249)
+  } else {
+    println(0)
+  }
+  if (v250 > 1) {
+    println(v250)
+  } else {
+    println(0)
+  }
+  if (v251 > 1) {
+    println(v251)
+  } else {
+    println(0)
+  }
+  if (v252 > 1) {
+    println(v252)
+  } else {
+    println(0)
+  }
+  if (v253 > 1) {
+    println(v253)
+  } else {
+    println(0)
+  }
+  if (v254 > 1) {
+    println(v254)
+  } else {
+    println(0)
+  }
+  if (v255 > 1) {
+    println(v255)
+  } else {
+    println(0)
+  }
+  if (v256 > 1) {
+    println(v256)
+  } else {
+    println(0)
+  }
+  if (v257 > 1) {
+    println(v257)
+  } else {
+    println(0)
+  }
+  if (v258 > 1) {
+    println(v258)
+  } else {
+    println(0)
+  }
+  if (v259 > 1) {
+    println(v259)
+  } else {
+    println(0)
+  }
+  if (v260 > 1) {
+    println(v260)
+  } else {
+    println(0)
+  }
+  if (v261 > 1) {
+    println(v261)
+  } else {
+    println(0)
+  }
+  if (v262 > 1) {
+    println(v262)
+  } else {
+    println(0)
+  }
+  if (v263 > 1) {
+    println(v263)
+  } else {
+    println(0)
+  }
+  if (v264 > 1) {
+    println(v264)
+  } else {
+    println(0)
+  }
+  if (v265 > 1) {
+    println(v265)
+  } else {
+    println(0)
+  }
+  if (v266 > 1) {
+    println(v266)
+  } else {
+    println(0)
+  }
+  if (v267 > 1) {
+    println(v267)
+  } else {
+    println(0)
+  }
+  if (v268 > 1) {
+    println(v268)
+  } else {
+    println(0)
+  }
+  if (v269 > 1) {
+    println(v269)
+  } else {
+    println(0)
+  }
+  if (v270 > 1) {
+    println(v270)
+  } else {
+    println(0)
+  }
+  if (v271 > 1) {
+    println(v271)
+  } else {
+    println(0)
+  }
+  if (v272 > 1) {
+    println(v272)
+  } else {
+    println(0)
+  }
+  if (v273 > 1) {
+    println(v273)
+  } else {
+    println(0)
+  }
+  if (v274 > 1) {
+    println(v274)
+  } else {
+    println(0)
+  }
+  if (v275 > 1) {
+    println(v275)
+  } else {
+    println(0)
+  }
+  if (v276 > 1) {
+    println(v276)
+  } else {
+    println(0)
+  }
+  if (v277 > 1) {
+    println(v277)
+  } else {
+    println(0)
+  }
+  if (v278 > 1) {
+    println(v278)
+  } else {
+    println(0)
+  }
+  if (v279 > 1) {
+    println(v279)
+  } else {
+    println(0)
+  }
+  if (v280 > 1) {
+    println(v280)
+  } else {
+    println(0)
+  }
+  if (v281 > 1) {
+    println(v281)
+  } else {
+    println(0)
+  }
+  if (v282 > 1) {
+    println(v282)
+  } else {
+    println(0)
+  }
+  if (v283 > 1) {
+    println(v283)
+  } else {
+    println(0)
+  }
+  if (v284 > 1) {
+    println(v284)
+  } else {
+    println(0)
+  }
+  if (v285 > 1) {
+    println(v285)
+  } else {
+    println(0)
+  }
+  if (v286 > 1) {
+    println(v286)
+  } else {
+    println(0)
+  }
+  if (v287 > 1) {
+    println(v287)
+  } else {
+    println(0)
+  }
+  if (v288 > 1) {
+    println(v288)
+  } else {
+    println(0)
+  }
+  if (v289 > 1) {
+    println(v289)
+  } else {
+    println(0)
+  }
+  if (v290 > 1) {
+    println(v290)
+  } else {
+    println(0)
+  }
+  if (v291 > 1) {
+    println(v291)
+  } else {
+    println(0)
+  }
+  if (v292 > 1) {
+    println(v292)
+  } else {
+    println(0)
+  }
+  if (v293 > 1) {
+    println(v293)
+  } else {
+    println(0)
+  }
+  if (v294 > 1) {
+    println(v294)
+  } else {
+    println(0)
+  }
+  if (v295 > 1) {
+    println(v295)
+  } else {
+    println(0)
+  }
+  if (v296 > 1) {
+    println(v296)
+  } else {
+    println(0)
+  }
+  if (v297 > 1) {
+    println(v297)
+  } else {
+    println(0)
+  }
+  if (v298 > 1) {
+    println(v298)
+  } else {
+    println(0)
+  }
+  if (v299 > 1) {
+    println(v299)
+  } else {
+    println(0)
+  }
+  if (v300 > 1) {
+    println(v300)
+  } else {
+    println(0)
+  }
+  if (v301 > 1) {
+    println(v301)
+  } else {
+    println(0)
+  }
+  if (v302 > 1) {
+    println(v302)
+  } else {
+    println(0)
+  }
+  if (v303 > 1) {
+    println(v303)
+  } else {
+    println(0)
+  }
+  if (v304 > 1) {
+    println(v304)
+  } else {
+    println(0)
+  }
+  if (v305 > 1) {
+    println(v305)
+  } else {
+    println(0)
+  }
+  if (v306 > 1) {
+    println(v306)
+  } else {
+    println(0)
+  }
+  if (v307 > 1) {
+    println(v307)
+  } else {
+    println(0)
+  }
+  if (v308 > 1) {
+    println(v308)
+  } else {
+    println(0)
+  }
+  if (v309 > 1) {
+    println(v309)
+  } else {
+    println(0)
+  }
+  if (v310 > 1) {
+    println(v310)
+  } else {
+    println(0)
+  }
+  if (v311 > 1) {
+    println(v311)
+  } else {
+    println(0)
+  }
+  if (v312 > 1) {
+    println(v312)
+  } else {
+    println(0)
+  }
+  if (v313 > 1) {
+    println(v313)
+  } else {
+    println(0)
+  }
+  if (v314 > 1) {
+    println(v314)
+  } else {
+    println(0)
+  }
+  if (v315 > 1) {
+    println(v315)
+  } else {
+    println(0)
+  }
+  if (v316 > 1) {
+    println(v316)
+  } else {
+    println(0)
+  }
+  if (v317 > 1) {
+    println(v317)
+  } else {
+    println(0)
+  }
+  if (v318 > 1) {
+    println(v318)
+  } else {
+    println(0)
+  }
+  if (v319 > 1) {
+    println(v319)
+  } else {
+    println(0)
+  }
+  if (v320 > 1) {
+    println(v320)
+  } else {
+    println(0)
+  }
+  if (v321 > 1) {
+    println(v321)
+  } else {
+    println(0)
+  }
+  if (v322 > 1) {
+    println(v322)
+  } else {
+    println(0)
+  }
+  if (v323 > 1) {
+    println(v323)
+  } else {
+    println(0)
+  }
+  if (v324 > 1) {
+    println(v324)
+  } else {
+    println(0)
+  }
+  if (v325 > 1) {
+    println(v325)
+  } else {
+    println(0)
+  }
+  if (v326 > 1) {
+    println(v326)
+  } else {
+    println(0)
+  }
+  if (v327 > 1) {
+    println(v327)
+  } else {
+    println(0)
+  }
+  if (v328 > 1) {
+    println(v328)
+  } else {
+    println(0)
+  }
+  if (v329 > 1) {
+    println(v329)
+  } else {
+    println(0)
+  }
+  if (v330 > 1) {
+    println(v330)
+  } else {
+    println(0)
+  }
+  if (v331 > 1) {
+    println(v331)
+  } else {
+    println(0)
+  }
+  if (v332 > 1) {
+    println(v332)
+  } else {
+    println(0)
+  }
+  if (v333 > 1) {
+    println(v333)
+  } else {
+    println(0)
+  }
+  if (v334 > 1) {
+    println(v334)
+  } else {
+    println(0)
+  }
+  if (v335 > 1) {
+    println(v335)
+  } else {
+    println(0)
+  }
+  if (v336 > 1) {
+    println(v336)
+  } else {
+    println(0)
+  }
+  if (v337 > 1) {
+    println(v337)
+  } else {
+    println(0)
+  }
+  if (v338 > 1) {
+    println(v338)
+  } else {
+    println(0)
+  }
+  if (v339 > 1) {
+    println(v339)
+  } else {
+    println(0)
+  }
+  if (v340 > 1) {
+    println(v340)
+  } else {
+    println(0)
+  }
+  if (v341 > 1) {
+    println(v341)
+  } else {
+    println(0)
+  }
+  if (v342 > 1) {
+    println(v342)
+  } else {
+    println(0)
+  }
+  if (v343 > 1) {
+    println(v343)
+  } else {
+    println(0)
+  }
+  if (v344 > 1) {
+    println(v344)
+  } else {
+    println(0)
+  }
+  if (v345 > 1) {
+    println(v345)
+  } else {
+    println(0)
+  }
+  if (v346 > 1) {
+    println(v346)
+  } else {
+    println(0)
+  }
+  if (v347 > 1) {
+    println(v347)
+  } else {
+    println(0)
+  }
+  if (v348 > 1) {
+    println(v348)
+  } else {
+    println(0)
+  }
+  if (v349 > 1) {
+    println(v349)
+  } else {
+    println(0)
+  }
+  if (v350 > 1) {
+    println(v350)
+  } else {
+    println(0)
+  }
+  if (v351 > 1) {
+    println(v351)
+  } else {
+    println(0)
+  }
+  if (v352 > 1) {
+    println(v352)
+  } else {
+    println(0)
+  }
+  if (v353 > 1) {
+    println(v353)
+  } else {
+    println(0)
+  }
+  if (v354 > 1) {
+    println(v354)
+  } else {
+    println(0)
+  }
+  if (v355 > 1) {
+    println(v355)
+  } else {
+    println(0)
+  }
+  if (v356 > 1) {
+    println(v356)
+  } else {
+    println(0)
+  }
+  if (v357 > 1) {
+    println(v357)
+  } else {
+    println(0)
+  }
+  if (v358 > 1) {
+    println(v358)
+  } else {
+    println(0)
+  }
+  if (v359 > 1) {
+    println(v359)
+  } else {
+    println(0)
+  }
+  if (v360 > 1) {
+    println(v360)
+  } else {
+    println(0)
+  }
+  if (v361 > 1) {
+    println(v361)
+  } else {
+    println(0)
+  }
+  if (v362 > 1) {
+    println(v362)
+  } else {
+    println(0)
+  }
+  if (v363 > 1) {
+    println(v363)
+  } else {
+    println(0)
+  }
+  if (v364 > 1) {
+    println(v364)
+  } else {
+    println(0)
+  }
+  if (v365 > 1) {
+    println(v365)
+  } else {
+    println(0)
+  }
+  if (v366 > 1) {
+    println(v366)
+  } else {
+    println(0)
+  }
+  if (v367 > 1) {
+    println(v367)
+  } else {
+    println(0)
+  }
+  if (v368 > 1) {
+    println(v368)
+  } else {
+    println(0)
+  }
+  if (v369 > 1) {
+    println(v369)
+  } else {
+    println(0)
+  }
+  if (v370 > 1) {
+    println(v370)
+  } else {
+    println(0)
+  }
+  if (v371 > 1) {
+    println(v371)
+  } else {
+    println(0)
+  }
+  if (v372 > 1) {
+    println(v372)
+  } else {
+    println(0)
+  }
+  if (v373 > 1) {
+    println(v373)
+  } else {
+    println(0)
+  }
+  if (v374 > 1) {
+    println(v374)
+  } else {
+    println(0)
+  }
+  if (v375 > 1) {
+    println(v375)
+  } else {
+    println(0)
+  }
+  if (v376 > 1) {
+    println(v376)
+  } else {
+    println(0)
+  }
+  if (v377 > 1) {
+    println(v377)
+  } else {
+    println(0)
+  }
+  if (v378 > 1) {
+    println(v378)
+  } else {
+    println(0)
+  }
+  if (v379 > 1) {
+    println(v379)
+  } else {
+    println(0)
+  }
+  if (v380 > 1) {
+    println(v380)
+  } else {
+    println(0)
+  }
+  if (v381 > 1) {
+    println(v381)
+  } else {
+    println(0)
+  }
+  if (v382 > 1) {
+    println(v382)
+  } else {
+    println(0)
+  }
+  if (v383 > 1) {
+    println(v383)
+  } else {
+    println(0)
+  }
+  if (v384 > 1) {
+    println(v384)
+  } else {
+    println(0)
+  }
+  if (v385 > 1) {
+    println(v385)
+  } else {
+    println(0)
+  }
+  if (v386 > 1) {
+    println(v386)
+  } else {
+    println(0)
+  }
+  if (v387 > 1) {
+    println(v387)
+  } else {
+    println(0)
+  }
+  if (v388 > 1) {
+    println(v388)
+  } else {
+    println(0)
+  }
+  if (v389 > 1) {
+    println(v389)
+  } else {
+    println(0)
+  }
+  if (v390 > 1) {
+    println(v390)
+  } else {
+    println(0)
+  }
+  if (v391 > 1) {
+    println(v391)
+  } else {
+    println(0)
+  }
+  if (v392 > 1) {
+    println(v392)
+  } else {
+    println(0)
+  }
+  if (v393 > 1) {
+    println(v393)
+  } else {
+    println(0)
+  }
+  if (v394 > 1) {
+    println(v394)
+  } else {
+    println(0)
+  }
+  if (v395 > 1) {
+    println(v395)
+  } else {
+    println(0)
+  }
+  if (v396 > 1) {
+    println(v396)
+  } else {
+    println(0)
+  }
+  if (v397 > 1) {
+    println(v397)
+  } else {
+    println(0)
+  }
+  if (v398 > 1) {
+    println(v398)
+  } else {
+    println(0)
+  }
+  if (v399 > 1) {
+    println(v399)
+  } else {
+    println(0)
+  }
+  if (v400 > 1) {
+    println(v400)
+  } else {
+    println(0)
+  }
+  if (v401 > 1) {
+    println(v401)
+  } else {
+    println(0)
+  }
+  if (v402 > 1) {
+    println(v402)
+  } else {
+    println(0)
+  }
+  if (v403 > 1) {
+    println(v403)
+  } else {
+    println(0)
+  }
+  if (v404 > 1) {
+    println(v404)
+  } else {
+    println(0)
+  }
+  if (v405 > 1) {
+    println(v405)
+  } else {
+    println(0)
+  }
+  if (v406 > 1) {
+    println(v406)
+  } else {
+    println(0)
+  }
+  if (v407 > 1) {
+    println(v407)
+  } else {
+    println(0)
+  }
+  if (v408 > 1) {
+    println(v408)
+  } else {
+    println(0)
+  }
+  if (v409 > 1) {
+    println(v409)
+  } else {
+    println(0)
+  }
+  if (v410 > 1) {
+    println(v410)
+  } else {
+    println(0)
+  }
+  if (v411 > 1) {
+    println(v411)
+  } else {
+    println(0)
+  }
+  if (v412 > 1) {
+    println(v412)
+  } else {
+    println(0)
+  }
+  if (v413 > 1) {
+    println(v413)
+  } else {
+    println(0)
+  }
+  if (v414 > 1) {
+    println(v414)
+  } else {
+    println(0)
+  }
+  if (v415 > 1) {
+    println(v415)
+  } else {
+    println(0)
+  }
+  if (v416 > 1) {
+    println(v416)
+  } else {
+    println(0)
+  }
+  if (v417 > 1) {
+    println(v417)
+  } else {
+    println(0)
+  }
+  if (v418 > 1) {
+    println(v418)
+  } else {
+    println(0)
+  }
+  if (v419 > 1) {
+    println(v419)
+  } else {
+    println(0)
+  }
+  if (v420 > 1) {
+    println(v420)
+  } else {
+    println(0)
+  }
+  if (v421 > 1) {
+    println(v421)
+  } else {
+    println(0)
+  }
+  if (v422 > 1) {
+    println(v422)
+  } else {
+    println(0)
+  }
+  if (v423 > 1) {
+    println(v423)
+  } else {
+    println(0)
+  }
+  if (v424 > 1) {
+    println(v424)
+  } else {
+    println(0)
+  }
+  if (v425 > 1) {
+    println(v425)
+  } else {
+    println(0)
+  }
+  if (v426 > 1) {
+    println(v426)
+  } else {
+    println(0)
+  }
+  if (v427 > 1) {
+    println(v427)
+  } else {
+    println(0)
+  }
+  if (v428 > 1) {
+    println(v428)
+  } else {
+    println(0)
+  }
+  if (v429 > 1) {
+    println(v429)
+  } else {
+    println(0)
+  }
+  if (v430 > 1) {
+    println(v430)
+  } else {
+    println(0)
+  }
+  if (v431 > 1) {
+    println(v431)
+  } else {
+    println(0)
+  }
+  if (v432 > 1) {
+    println(v432)
+  } else {
+    println(0)
+  }
+  if (v433 > 1) {
+    println(v433)
+  } else {
+    println(0)
+  }
+  if (v434 > 1) {
+    println(v434)
+  } else {
+    println(0)
+  }
+  if (v435 > 1) {
+    println(v435)
+  } else {
+    println(0)
+  }
+  if (v436 > 1) {
+    println(v436)
+  } else {
+    println(0)
+  }
+  if (v437 > 1) {
+    println(v437)
+  } else {
+    println(0)
+  }
+  if (v438 > 1) {
+    println(v438)
+  } else {
+    println(0)
+  }
+  if (v439 > 1) {
+    println(v439)
+  } else {
+    println(0)
+  }
+  if (v440 > 1) {
+    println(v440)
+  } else {
+    println(0)
+  }
+  if (v441 > 1) {
+    println(v441)
+  } else {
+    println(0)
+  }
+  if (v442 > 1) {
+    println(v442)
+  } else {
+    println(0)
+  }
+  if (v443 > 1) {
+    println(v443)
+  } else {
+    println(0)
+  }
+  if (v444 > 1) {
+    println(v444)
+  } else {
+    println(0)
+  }
+  if (v445 > 1) {
+    println(v445)
+  } else {
+    println(0)
+  }
+  if (v446 > 1) {
+    println(v446)
+  } else {
+    println(0)
+  }
+  if (v447 > 1) {
+    println(v447)
+  } else {
+    println(0)
+  }
+  if (v448 > 1) {
+    println(v448)
+  } else {
+    println(0)
+  }
+  if (v449 > 1) {
+    println(v449)
+  } else {
+    println(0)
+  }
+  if (v450 > 1) {
+    println(v450)
+  } else {
+    println(0)
+  }
+  if (v451 > 1) {
+    println(v451)
+  } else {
+    println(0)
+  }
+  if (v452 > 1) {
+    println(v452)
+  } else {
+    println(0)
+  }
+  if (v453 > 1) {
+    println(v453)
+  } else {
+    println(0)
+  }
+  if (v454 > 1) {
+    println(v454)
+  } else {
+    println(0)
+  }
+  if (v455 > 1) {
+    println(v455)
+  } else {
+    println(0)
+  }
+  if (v456 > 1) {
+    println(v456)
+  } else {
+    println(0)
+  }
+  if (v457 > 1) {
+    println(v457)
+  } else {
+    println(0)
+  }
+  if (v458 > 1) {
+    println(v458)
+  } else {
+    println(0)
+  }
+  if (v459 > 1) {
+    println(v459)
+  } else {
+    println(0)
+  }
+  if (v460 > 1) {
+    println(v460)
+  } else {
+    println(0)
+  }
+  if (v461 > 1) {
+    println(v461)
+  } else {
+    println(0)
+  }
+  if (v462 > 1) {
+    println(v462)
+  } else {
+    println(0)
+  }
+  if (v463 > 1) {
+    println(v463)
+  } else {
+    println(0)
+  }
+  if (v464 > 1) {
+    println(v464)
+  } else {
+    println(0)
+  }
+  if (v465 > 1) {
+    println(v465)
+  } else {
+    println(0)
+  }
+  if (v466 > 1) {
+    println(v466)
+  } else {
+    println(0)
+  }
+  if (v467 > 1) {
+    println(v467)
+  } else {
+    println(0)
+  }
+  if (v468 > 1) {
+    println(v468)
+  } else {
+    println(0)
+  }
+  if (v469 > 1) {
+    println(v469)
+  } else {
+    println(0)
+  }
+  if (v470 > 1) {
+    println(v470)
+  } else {
+    println(0)
+  }
+  if (v471 > 1) {
+    println(v471)
+  } else {
+    println(0)
+  }
+  if (v472 > 1) {
+    println(v472)
+  } else {
+    println(0)
+  }
+  if (v473 > 1) {
+    println(v473)
+  } else {
+    println(0)
+  }
+  if (v474 > 1) {
+    println(v474)
+  } else {
+    println(0)
+  }
+  if (v475 > 1) {
+    println(v475)
+  } else {
+    println(0)
+  }
+  if (v476 > 1) {
+    println(v476)
+  } else {
+    println(0)
+  }
+  if (v477 > 1) {
+    println(v477)
+  } else {
+    println(0)
+  }
+  if (v478 > 1) {
+    println(v478)
+  } else {
+    println(0)
+  }
+  if (v479 > 1) {
+    println(v479)
+  } else {
+    println(0)
+  }
+  if (v480 > 1) {
+    println(v480)
+  } else {
+    println(0)
+  }
+  if (v481 > 1) {
+    println(v481)
+  } else {
+    println(0)
+  }
+  if (v482 > 1) {
+    println(v482)
+  } else {
+    println(0)
+  }
+  if (v483 > 1) {
+    println(v483)
+  } else {
+    println(0)
+  }
+  if (v484 > 1) {
+    println(v484)
+  } else {
+    println(0)
+  }
+  if (v485 > 1) {
+    println(v485)
+  } else {
+    println(0)
+  }
+  if (v486 > 1) {
+    println(v486)
+  } else {
+    println(0)
+  }
+  if (v487 > 1) {
+    println(v487)
+  } else {
+    println(0)
+  }
+  if (v488 > 1) {
+    println(v488)
+  } else {
+    println(0)
+  }
+  if (v489 > 1) {
+    println(v489)
+  } else {
+    println(0)
+  }
+  if (v490 > 1) {
+    println(v490)
+  } else {
+    println(0)
+  }
+  if (v491 > 1) {
+    println(v491)
+  } else {
+    println(0)
+  }
+  if (v492 > 1) {
+    println(v492)
+  } else {
+    println(0)
+  }
+  if (v493 > 1) {
+    println(v493)
+  } else {
+    println(0)
+  }
+  if (v494 > 1) {
+    println(v494)
+  } else {
+    println(0)
+  }
+  if (v495 > 1) {
+    println(v495)
+  } else {
+    println(0)
+  }
+  if (v496 > 1) {
+    println(v496)
+  } else {
+    println(0)
+  }
+  if (v497 > 1) {
+    println(v497)
+  } else {
+    println(0)
+  }
+  if (v498 > 1) {
+    println(v498)
+  } else {
+    println(0)
+  }
+  if (v499 > 1) {
+    println(v499)
+  } else {
+    println(0)
+  }
+}
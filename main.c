@@ -14,14 +14,18 @@ static const char *usage =
     // clang-format off
 "A small compiler for the Kotlin programming language."
 "\n"
-"\n  %s [OPTIONS] <path>"
+"\n  %s [OPTIONS] <path>..."
 "\n"
 "\nEXAMPLES:"
 "\n  %s -j /usr/lib/jvm/java-21-openjdk-amd64/ -c /usr/share/java/kotlin-stdlib.jar main.kt"
 "\n"
 "\nOPTIONS:"
 "\n  -v, --verbose                  Verbose."
+"\n  -a, --dump-ast                 Print the AST to stderr after parsing."
+"\n  -t, --dump-types               Print the typed AST to stderr after type checking."
 "\n  -m, --memory-usage             Debug memory usage by printing a heap dump in the pprof format."
+"\n  -n, --no-cache                 Do not read nor write the class path cache."
+"\n  -V, --verify                   Parse the generated class files back as a sanity check (default in debug builds)."
 "\n  -h, --help                     Print this help message and exit."
 "\n  -c, --classpath <classpath>    Load additional classpath entries, which are colon separated."
 "\n  -j, --java-home <java_home>    Java home (the root of the Java installation)."
@@ -34,6 +38,10 @@ static struct option long_cli_options[] = {
     {.name = "memory-usage", .has_arg = false, .val = 'm'},
     {.name = "classpath", .has_arg = true, .val = 'c'},
     {.name = "verbose", .has_arg = false, .val = 'v'},
+    {.name = "no-cache", .has_arg = false, .val = 'n'},
+    {.name = "verify", .has_arg = false, .val = 'V'},
+    {.name = "dump-ast", .has_arg = false, .val = 'a'},
+    {.name = "dump-types", .has_arg = false, .val = 't'},
     {.name = "help", .has_arg = false, .val = 'h'},
 };
 
@@ -51,9 +59,16 @@ int main(int argc, char *argv[]) {
   Str cli_classpath = str_from_c(".");
   Str cli_java_home = {0};
   bool cli_mem_debug = false;
+  bool cli_dump_ast = false;
+  bool cli_dump_types = false;
+#ifdef __OPTIMIZE__
+  bool cli_verify = false;
+#else
+  bool cli_verify = true;
+#endif
 
   int options_index = 0;
-  while ((opt = getopt_long(argc, argv, "hmvc:j:", long_cli_options,
+  while ((opt = getopt_long(argc, argv, "hamntvVc:j:", long_cli_options,
                             &options_index)) != -1) {
     switch (opt) {
     case 'v':
@@ -72,6 +87,22 @@ int main(int argc, char *argv[]) {
       cli_mem_debug = true;
       break;
 
+    case 'n':
+      cli_no_cache = true;
+      break;
+
+    case 'V':
+      cli_verify = true;
+      break;
+
+    case 'a':
+      cli_dump_ast = true;
+      break;
+
+    case 't':
+      cli_dump_types = true;
+      break;
+
     case 'j':
       cli_java_home = str_from_c(optarg);
       break;
@@ -108,10 +139,6 @@ int main(int argc, char *argv[]) {
     fprintf(stderr, "Missing source file.\n");
     print_usage_and_exit(argv[0]);
   }
-  if (optind != argc - 1) {
-    fprintf(stderr, "Multiple source files not yet supported.\n");
-    print_usage_and_exit(argv[0]);
-  }
   if (str_is_empty(cli_java_home)) {
     fprintf(stderr, "Missing required option -j, --java-home.\n");
     print_usage_and_exit(argv[0]);
@@ -130,9 +157,10 @@ int main(int argc, char *argv[]) {
   Array(Str) class_path_entries =
       class_path_string_to_class_path_entries(cli_classpath, &arena);
 
-  {
-    // TODO: when parsing multiple files, need to allocate that.
-    char *source_file_name_cstr = argv[optind];
+  Array(Source_file) source_files =
+      array_make(Source_file, 0, (u32)(argc - optind), &arena);
+  for (int i = optind; i < argc; i++) {
+    char *source_file_name_cstr = argv[i];
     Str source_file_name = str_from_c(source_file_name_cstr);
     if (!str_ends_with(source_file_name, str_from_c(".kt"))) {
       fprintf(stderr, "Expected an input file ending with .kt\n");
@@ -150,103 +178,156 @@ int main(int argc, char *argv[]) {
       fprintf(stderr, "The source file %.*s is too big: got %lu, max is %u\n",
               (int)source_file_name.len, source_file_name.data,
               source_file_read_res.content.len, UINT32_MAX);
-      return false;
       exit(E2BIG);
     }
 
-    // Lex.
-    Lexer lexer = {.file_path = source_file_name};
-
-    Str source = source_file_read_res.content;
-    u8 *current = source.data;
-    lex_lex(&lexer, source, &current, &arena);
-
-    // Parse.
-    Parser parser = {
-        .buf = source,
-        .lexer = &lexer,
+    *array_push(&source_files, &arena) = (Source_file){
+        .file_path = source_file_name,
+        .source = source_file_read_res.content,
+        .class_file_path =
+            jvm_make_class_file_path_kt(source_file_name, &arena),
     };
-    const Ast_handle root_handle = parser_parse(&parser, &arena);
-    parser_ast_fprint(&parser, root_handle, stderr, 0, 0, arena);
-
-    if (parser.state != PARSER_STATE_OK)
-      return 1; // TODO: Should type checking still proceed?
-
-    const Str class_file_path =
-        jvm_make_class_file_path_kt(source_file_name, &arena);
-
-    Resolver resolver = {0};
-    resolver_init(&resolver, &parser, class_path_entries, class_file_path,
-                  &arena);
+  }
 
-    resolver_load_standard_types(&resolver, cli_java_home, scratch_arena,
-                                 &arena);
-    LOG("After loading known types: arena_available=%lu",
-        arena.end - arena.start);
+  // All classes are emitted without a package, so source files with the same
+  // name in different directories would overwrite each other's class.
+  for (u64 i = 0; i < source_files.len; i++) {
+    const Source_file *const source_file = &source_files.data[i];
+    Arena names_arena = scratch_arena;
+    const Str class_name = codegen_make_class_name_from_path(
+        source_file->class_file_path, &names_arena);
+
+    for (u64 j = 0; j < i; j++) {
+      const Source_file *const other = &source_files.data[j];
+      Arena tmp_arena = names_arena;
+      if (!str_eq(class_name, codegen_make_class_name_from_path(
+                                  other->class_file_path, &tmp_arena)))
+        continue;
+
+      fprintf(stderr,
+              "The source files %.*s and %.*s would both be compiled to the "
+              "class %.*s\n",
+              (int)other->file_path.len, other->file_path.data,
+              (int)source_file->file_path.len, source_file->file_path.data,
+              (int)class_name.len, class_name.data);
+      exit(EINVAL);
+    }
+  }
 
-    const u32 methods_count = resolver_user_defined_function_signatures(
-        &resolver, root_handle, scratch_arena, &arena);
-    resolver_resolve_ast(&resolver, root_handle, scratch_arena, &arena);
+  // Lex & parse.
+  parser_parse_source_files(source_files, scratch_arena, &arena);
+  LOG("After parsing: arena_available=%lu", arena.end - arena.start);
+
+  bool parsed_ok = true;
+  for (u64 i = 0; i < source_files.len; i++) {
+    const Source_file *const source_file = &source_files.data[i];
+    if (cli_dump_ast) {
+      Arena dump_arena = scratch_arena;
+      Str_builder dump = sb_new(64 * KiB, &dump_arena);
+      parser_ast_print(&source_file->parser, source_file->root_handle, &dump,
+                       &dump_arena, 0, 0, arena);
+      fwrite(dump.data, sizeof(u8), dump.len, stderr);
+    }
 
-    // Debug types.
-    {
-      LOG("------ After type checking%s", "");
-      LOG("After type checking: arena_available=%lu", arena.end - arena.start);
+    parsed_ok &= source_file->parser.state == PARSER_STATE_OK;
+  }
+  if (!parsed_ok)
+    return 1; // TODO: Should type checking still proceed?
+
+  Resolver resolver = {0};
+  resolver_init(&resolver, class_path_entries, &arena);
+
+  resolver_load_standard_types(&resolver, cli_java_home, scratch_arena, &arena);
+  LOG("After loading known types: arena_available=%lu",
+      arena.end - arena.start);
+
+  // Functions can be called from any source file, so all the signatures are
+  // known before type checking the function bodies.
+  for (u64 i = 0; i < source_files.len; i++) {
+    Source_file *const source_file = &source_files.data[i];
+    resolver_begin_file(&resolver, source_file, &arena);
+    source_file->methods_count = resolver_user_defined_function_signatures(
+        &resolver, source_file->root_handle, scratch_arena, &arena);
+  }
 
-      Arena tmp_arena = arena;
-      resolver_ast_fprint(&resolver, root_handle, stderr, 0, 0, tmp_arena,
-                          arena);
+  // Type check every source file before emitting anything, so that an error
+  // in one file does not leave the classes of the others on disk.
+  bool resolved_ok = true;
+  for (u64 i = 0; i < source_files.len; i++) {
+    Source_file *const source_file = &source_files.data[i];
+    resolver_begin_file(&resolver, source_file, &arena);
+    resolver_resolve_ast(&resolver, source_file->root_handle, scratch_arena,
+                         &arena);
+
+    LOG("After type checking: arena_available=%lu", arena.end - arena.start);
+
+    if (cli_dump_types) {
+      Arena dump_arena = scratch_arena;
+      Str_builder dump = sb_new(64 * KiB, &dump_arena);
+      resolver_ast_print(&resolver, source_file->root_handle, &dump,
+                         &dump_arena, 0, 0, arena, arena);
+      fwrite(dump.data, sizeof(u8), dump.len, stderr);
     }
 
-    if (parser.state != PARSER_STATE_OK)
-      return 1;
+    resolved_ok &= source_file->parser.state == PARSER_STATE_OK;
+  }
+  if (!resolved_ok)
+    return 1;
+
+  // Emit bytecode. Code generation can still report errors, so the class files
+  // are only written once all of them have been generated.
+  Array(Str) class_file_contents =
+      array_make(Str, 0, source_files.len, &arena);
+  for (u64 i = 0; i < source_files.len; i++) {
+    Source_file *const source_file = &source_files.data[i];
+    resolver_begin_file(&resolver, source_file, &arena);
 
-    // Emit bytecode.
     Class_file class_file = {
-        .class_file_path = class_file_path,
+        .class_file_path = source_file->class_file_path,
         .minor_version = 0,
         .major_version =
             17, // TODO: Add a CLI option to choose the jdk/jre version
         .access_flags = ACCESS_FLAGS_SUPER | ACCESS_FLAGS_PUBLIC,
     };
-    jvm_init(&class_file, methods_count, &arena);
-    codegen_emit(&resolver, &class_file, root_handle, &arena);
-    if (parser.state != PARSER_STATE_OK)
+    jvm_init(&class_file, source_file->methods_count, &arena);
+    codegen_emit(&resolver, &class_file, source_file->root_handle, &arena);
+    if (source_file->parser.state != PARSER_STATE_OK)
       return 1;
 
-    char *class_file_path_c_str =
-        str_to_c(class_file.class_file_path, &scratch_arena);
-    FILE *file = fopen(class_file_path_c_str, "w");
-    if (file == NULL) {
-      fprintf(stderr, "Failed to open the file %.*s: %s\n",
-              (int)source_file_name.len, (char *)source_file_name.data,
-              strerror(errno));
-      return errno;
-    }
-    jvm_write_class_file(&class_file, file);
-    fclose(file);
+    const Str class_file_content = jvm_write_class_file(&class_file, &arena);
+    *array_push(&class_file_contents, &arena) = class_file_content;
 
     LOG("After codegen: arena_available=%lu", arena.end - arena.start);
 
-    {
+    if (cli_verify) {
       LOG("\n----------- Verifying%s", "");
 
-      Read_result read_res =
-          ut_file_read_all(class_file_path_c_str, &scratch_arena);
-      if (read_res.error) {
-        fprintf(stderr, "Failed to read the file %.*s: %s\n",
-                (int)class_file_path.len, (char *)class_file_path.data,
-                strerror(read_res.error));
-        return read_res.error;
-      }
-
+      Arena tmp_arena = scratch_arena;
       Class_file class_file_verify = {.class_file_path =
                                           class_file.class_file_path};
-      u8 *current = read_res.content.data;
-      jvm_buf_read_class_file(read_res.content, &current, &class_file_verify,
-                              &scratch_arena);
+      if (!jvm_buf_read_class_file(class_file_content, &class_file_verify,
+                                   &tmp_arena))
+        exit(EINVAL);
     }
   }
+
+  for (u64 i = 0; i < source_files.len; i++) {
+    const Source_file *const source_file = &source_files.data[i];
+    const Str class_file_content = class_file_contents.data[i];
+
+    Arena tmp_arena = scratch_arena;
+    char *class_file_path_c_str =
+        str_to_c(source_file->class_file_path, &tmp_arena);
+    FILE *file = fopen(class_file_path_c_str, "w");
+    if (file == NULL) {
+      fprintf(stderr, "Failed to open the file %.*s: %s\n",
+              (int)source_file->file_path.len,
+              (char *)source_file->file_path.data, strerror(errno));
+      return errno;
+    }
+    fwrite(class_file_content.data, sizeof(u8), class_file_content.len, file);
+    fclose(file);
+  }
   if (cli_mem_debug) {
     FILE *f = fopen("profile.heap", "w");
     pg_assert(f);
@@ -5,6 +5,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
@@ -72,6 +73,20 @@ __attribute__((warn_unused_result)) static u64 ut_next_power_of_two(u64 n) {
   return n;
 }
 
+#define UT_FNV1A_OFFSET_BASIS 0xcbf29ce484222325UL
+
+// http://www.isthe.com/chongo/tech/comp/fnv/index.html#FNV-1a
+__attribute__((warn_unused_result)) static u64 ut_fnv1a(u64 hash,
+                                                        const void *data,
+                                                        u64 len) {
+  const u8 *const bytes = data;
+  for (u64 i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3UL;
+  }
+  return hash;
+}
+
 __attribute__((warn_unused_result)) static Str str_new(u8 *s, u64 n) {
   return (Str){.data = s, .len = n};
 }
@@ -115,6 +130,14 @@ __attribute__((warn_unused_result)) static bool str_ends_with_c(Str haystack,
   return str_ends_with(haystack, str_from_c(needle));
 }
 
+__attribute__((warn_unused_result)) static bool str_starts_with(Str haystack,
+                                                                Str needle) {
+  if (needle.len > haystack.len)
+    return false;
+
+  return memcmp(haystack.data, needle.data, needle.len) == 0;
+}
+
 __attribute__((warn_unused_result)) static bool str_is_empty(Str s) {
   return s.len == 0;
 }
@@ -272,6 +295,23 @@ sb_append_u64(Str_builder sb, u64 n, Arena *arena) {
   return sb_append_c(sb, tmp, arena);
 }
 
+__attribute__((warn_unused_result, format(printf, 3, 4))) static Str_builder
+sb_append_fmt(Str_builder sb, Arena *arena, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const int len = vsnprintf(NULL, 0, fmt, args);
+  va_end(args);
+  pg_assert(len >= 0);
+
+  sb = sb_reserve_at_least(sb, (u64)len, arena);
+
+  va_start(args, fmt);
+  vsnprintf((char *)sb_end_c(sb), (u64)len + 1, fmt, args);
+  va_end(args);
+
+  return sb_assume_appended_n(sb, (u64)len);
+}
+
 __attribute__((warn_unused_result)) static Str_builder
 sb_capitalize_at(Str_builder sb, u64 pos) {
   pg_assert(pos < sb.len);